@@ -0,0 +1,131 @@
+#define _GNU_SOURCE // MAP_HUGETLB, MADV_HUGEPAGE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include "arena.h"
+
+#define ARENA_ALIGN 16
+
+void arena_init(NodeArena* arena, size_t objectSize, ArenaPages pages) {
+    if (objectSize < sizeof(ArenaFreeSlot)) {
+        objectSize = sizeof(ArenaFreeSlot);
+    }
+    arena->object_size = (objectSize + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    arena->requested = pages;
+    arena->backing = pages;
+    arena->cursor = NULL;
+    arena->end = NULL;
+    arena->chunks = NULL;
+    arena->free_list = NULL;
+    arena->bytes_mapped = 0;
+    arena->objects = 0;
+}
+
+// Maps one chunk. THP only backs 2 MB aligned ranges, so the mapping is
+// over-allocated by a huge page and trimmed to an aligned start.
+static void* mapChunk(NodeArena* arena, size_t* length) {
+    void* base;
+
+#ifdef MAP_HUGETLB
+    if (arena->requested == ARENA_HUGETLB) {
+        base = mmap(NULL, ARENA_CHUNK_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) {
+            arena->backing = ARENA_HUGETLB;
+            *length = ARENA_CHUNK_SIZE;
+            return base;
+        }
+    }
+#endif
+
+    size_t padded = ARENA_CHUNK_SIZE + ARENA_HUGE_PAGE_SIZE;
+    base = mmap(NULL, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    uintptr_t start = ((uintptr_t)base + ARENA_HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(ARENA_HUGE_PAGE_SIZE - 1);
+    size_t head = start - (uintptr_t)base;
+    if (head > 0) {
+        munmap(base, head);
+    }
+    if (padded - head > ARENA_CHUNK_SIZE) {
+        munmap((char*)start + ARENA_CHUNK_SIZE, padded - head - ARENA_CHUNK_SIZE);
+    }
+
+    arena->backing = ARENA_SMALL_PAGES;
+#ifdef MADV_HUGEPAGE
+    if (arena->requested != ARENA_SMALL_PAGES && madvise((void*)start, ARENA_CHUNK_SIZE, MADV_HUGEPAGE) == 0) {
+        arena->backing = ARENA_THP;
+    }
+#endif
+    *length = ARENA_CHUNK_SIZE;
+    return (void*)start;
+}
+
+void* arena_alloc(NodeArena* arena) {
+    if (arena->free_list != NULL) {
+        ArenaFreeSlot* slot = arena->free_list;
+        arena->free_list = slot->next;
+        arena->objects++;
+        return slot;
+    }
+
+    if (arena->cursor == NULL || (size_t)(arena->end - arena->cursor) < arena->object_size) {
+        size_t length;
+        ArenaChunk* chunk = (ArenaChunk*)mapChunk(arena, &length);
+        if (chunk == NULL) {
+            printf("Memory allocation failed!\n");
+            exit(1);
+        }
+        chunk->next = arena->chunks;
+        chunk->length = length;
+        arena->chunks = chunk;
+        arena->bytes_mapped += length;
+        arena->cursor = (char*)chunk + ((sizeof(ArenaChunk) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1));
+        arena->end = (char*)chunk + length;
+    }
+
+    void* object = arena->cursor;
+    arena->cursor += arena->object_size;
+    arena->objects++;
+    return object;
+}
+
+void arena_free(NodeArena* arena, void* object) {
+    ArenaFreeSlot* slot = (ArenaFreeSlot*)object;
+    slot->next = arena->free_list;
+    arena->free_list = slot;
+    arena->objects--;
+}
+
+int arena_owns(NodeArena* arena, const void* object) {
+    for (ArenaChunk* chunk = arena->chunks; chunk != NULL; chunk = chunk->next) {
+        if ((const char*)object >= (const char*)chunk && (const char*)object < (const char*)chunk + chunk->length) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void arena_release(NodeArena* arena) {
+    ArenaChunk* chunk = arena->chunks;
+    while (chunk != NULL) {
+        ArenaChunk* next = chunk->next;
+        munmap(chunk, chunk->length);
+        chunk = next;
+    }
+    arena_init(arena, arena->object_size, arena->requested);
+}
+
+const char* arena_pages_name(ArenaPages pages) {
+    switch (pages) {
+    case ARENA_HUGETLB:
+        return "hugetlbfs 2 MB";
+    case ARENA_THP:
+        return "transparent huge";
+    default:
+        return "4 KB base";
+    }
+}
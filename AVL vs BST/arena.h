@@ -0,0 +1,57 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fixed-size object arena backed by large mmap'ed chunks instead of malloc.
+// Nodes allocated from one arena sit next to each other in a few big
+// mappings, and with huge pages each 2 MB of nodes costs one TLB entry
+// instead of 512. Freed objects go on a free list and are reused; the chunks
+// themselves only go back to the system in arena_release.
+
+#define ARENA_CHUNK_SIZE ((size_t)64 << 20) // a multiple of the 2 MB huge page size
+#define ARENA_HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+typedef enum {
+    ARENA_SMALL_PAGES, // plain mmap, base pages
+    ARENA_THP,         // mmap + madvise(MADV_HUGEPAGE), transparent huge pages
+    ARENA_HUGETLB      // MAP_HUGETLB from the hugetlbfs pool, falls back to ARENA_THP
+} ArenaPages;
+
+typedef struct ArenaChunk {
+    struct ArenaChunk* next;
+    size_t length; // of the whole mapping, header included
+} ArenaChunk;
+
+typedef struct ArenaFreeSlot {
+    struct ArenaFreeSlot* next;
+} ArenaFreeSlot;
+
+typedef struct {
+    size_t object_size; // rounded up to 16 bytes
+    ArenaPages requested;
+    ArenaPages backing; // what the last chunk actually got
+    char* cursor;       // bump allocation inside the newest chunk
+    char* end;
+    ArenaChunk* chunks;
+    ArenaFreeSlot* free_list;
+    size_t bytes_mapped;
+    long objects;       // live
+} NodeArena;
+
+void arena_init(NodeArena* arena, size_t objectSize, ArenaPages pages);
+void* arena_alloc(NodeArena* arena);
+void arena_free(NodeArena* arena, void* object);
+int arena_owns(NodeArena* arena, const void* object);
+void arena_release(NodeArena* arena); // unmaps everything, objects become invalid
+const char* arena_pages_name(ArenaPages pages);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
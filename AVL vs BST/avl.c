@@ -1,15 +1,35 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "avl.h"
+#include "memtrack.h"
+#include "output.h"
+
+static _Thread_local NodeArena* nodeArena = NULL;
+
+void avl_use_arena(NodeArena* arena) {
+    nodeArena = arena;
+}
+
+static void releaseAVLNode(AVLNode* node) { // back to wherever createAVLNode got it
+    if (nodeArena != NULL && arena_owns(nodeArena, node)) {
+        arena_free(nodeArena, node);
+    } else {
+        tracked_free(node);
+    }
+}
 
 AVLNode* createAVLNode(int data) {
-    AVLNode* newNode = (AVLNode*)malloc(sizeof(AVLNode)); // new avl node
+    AVLNode* newNode = nodeArena != NULL ? (AVLNode*)arena_alloc(nodeArena)
+                                         : (AVLNode*)tracked_malloc(sizeof(AVLNode)); // new avl node
     if (newNode == NULL) {
         printf("Memory allocation failed!\n");
         exit(1);
     }
     newNode->data = data;
     newNode->height = 1;
+#if AVL_ORDER_STATS
+    newNode->size = 1;
+#endif
     newNode->left = NULL;
     newNode->right = NULL;
     return newNode;
@@ -26,6 +46,21 @@ int maxHeight(int a, int b) {
     return (a > b) ? a : b;
 }
 
+#if AVL_ORDER_STATS
+static int subtreeSize(AVLNode* node) {
+    if (node == NULL) {
+        return 0;
+    }
+    return node->size;
+}
+
+static void updateSize(AVLNode* node) {
+    node->size = 1 + subtreeSize(node->left) + subtreeSize(node->right);
+}
+#else
+#define updateSize(node) ((void)0)
+#endif
+
 int getBalance(AVLNode* node) { // balance calculation
     if (node == NULL) {
         return 0;
@@ -43,8 +78,10 @@ AVLNode* rightRotate(AVLNode* y, AVLMetrics* metrics) {
     
     y->height = maxHeight(height(y->left), height(y->right)) + 1;
     x->height = maxHeight(height(x->left), height(x->right)) + 1;
+    updateSize(y);
+    updateSize(x);
     
-    metrics->rotations++;
+    METRIC_INC(metrics, rotations);
     
     return x;
 }
@@ -58,51 +95,103 @@ AVLNode* leftRotate(AVLNode* x, AVLMetrics* metrics) {
 
     x->height = maxHeight(height(x->left), height(x->right)) + 1;
     y->height = maxHeight(height(y->left), height(y->right)) + 1;
+    updateSize(x);
+    updateSize(y);
     
-    metrics->rotations++;
+    METRIC_INC(metrics, rotations);
     
     return y;
 }
 
-AVLNode* avl_insert(AVLNode* root, int data, AVLMetrics* metrics) { // insert into avl
+// Retracing after an update: *retrace is the number of ancestors whose height
+// has changed so far, or -1 once the change has been absorbed (or never began).
+// Like the METRIC_* counters it only exists in instrumented builds; with
+// TREE_METRICS=0 the RETRACE_* macros drop the extra argument and bookkeeping.
+#if TREE_METRICS
+#define RETRACE_PARAM , int* retrace
+#define RETRACE_ARG , retrace
+#define RETRACE_START(metrics) (METRIC_INC(metrics, retrace_ops), *retrace = 0)
+#define RETRACE_SAVE(node) int before = (node)->height
+#define RETRACE_STEP(node, metrics) retraceAncestor(before, node, retrace, metrics)
+
+static void retraceAncestor(int before, AVLNode* after, int* retrace, AVLMetrics* metrics) {
+    if (*retrace < 0) {
+        return;
+    }
+    METRIC_INC(metrics, retrace_steps);
+    if (after->height == before) {
+        METRIC_INC(metrics, stop_level[*retrace]);
+        *retrace = -1;
+    } else {
+        (*retrace)++;
+    }
+}
+
+static void retraceFinish(int retrace, AVLMetrics* metrics) { // still changing at the root
+    if (retrace >= 0) {
+        METRIC_INC(metrics, stop_level[retrace]);
+    }
+}
+#else
+#define RETRACE_PARAM
+#define RETRACE_ARG
+#define RETRACE_START(metrics) ((void)(metrics))
+#define RETRACE_SAVE(node) ((void)0)
+#define RETRACE_STEP(node, metrics) ((void)0)
+#endif
+
+static AVLNode* insertNode(AVLNode* root, int data, AVLMetrics* metrics RETRACE_PARAM) {
     // BST insertion
     if (root == NULL) {
+        RETRACE_START(metrics);
         return createAVLNode(data);
     }
     
-    metrics->comparisons++;
+    METRIC_INC(metrics, comparisons);
+    RETRACE_SAVE(root);
     
     if (data < root->data) {
-        root->left = avl_insert(root->left, data, metrics);
+        root->left = insertNode(root->left, data, metrics RETRACE_ARG);
     } else if (data > root->data) {
-        root->right = avl_insert(root->right, data, metrics);
+        root->right = insertNode(root->right, data, metrics RETRACE_ARG);
     } else {
         return root; 
     }
     
     root->height = 1 + maxHeight(height(root->left), height(root->right));
+    updateSize(root);
     
     int balance = getBalance(root);
     
     if (balance > 1 && data < root->left->data) {
-        return rightRotate(root, metrics);
-    }
-
-    if (balance < -1 && data > root->right->data) {
-        return leftRotate(root, metrics);
-    }
-    
-    if (balance > 1 && data > root->left->data) {
+        METRIC_INC(metrics, ll_rotations);
+        root = rightRotate(root, metrics);
+    } else if (balance < -1 && data > root->right->data) {
+        METRIC_INC(metrics, rr_rotations);
+        root = leftRotate(root, metrics);
+    } else if (balance > 1 && data > root->left->data) {
+        METRIC_INC(metrics, lr_rotations);
         root->left = leftRotate(root->left, metrics);
-        return rightRotate(root, metrics);
-    }
-
-    if (balance < -1 && data < root->right->data) {
+        root = rightRotate(root, metrics);
+    } else if (balance < -1 && data < root->right->data) {
+        METRIC_INC(metrics, rl_rotations);
         root->right = rightRotate(root->right, metrics);
-        return leftRotate(root, metrics);
+        root = leftRotate(root, metrics);
     }
     
+    RETRACE_STEP(root, metrics);
+    return root;
+}
+
+AVLNode* avl_insert(AVLNode* root, int data, AVLMetrics* metrics) { // insert into avl
+#if TREE_METRICS
+    int retrace = -1;
+    root = insertNode(root, data, metrics, &retrace);
+    retraceFinish(retrace, metrics);
     return root;
+#else
+    return insertNode(root, data, metrics);
+#endif
 }
 
 AVLNode* avl_search(AVLNode* root, int data, AVLMetrics* metrics) {
@@ -110,7 +199,7 @@ AVLNode* avl_search(AVLNode* root, int data, AVLMetrics* metrics) {
         return NULL;
     }
     
-    metrics->comparisons++;
+    METRIC_INC(metrics, comparisons);
     
     if (data == root->data) {
         return root;
@@ -121,66 +210,89 @@ AVLNode* avl_search(AVLNode* root, int data, AVLMetrics* metrics) {
     }
 }
 
-AVLNode* minValueNode(AVLNode* root) { // get the minimum value
-    AVLNode* current = root;
-    while (current->left != NULL) {
-        current = current->left;
-    }
-    return current;
-}
+#if defined(__GNUC__)
+#define AVL_PREFETCH(node) __builtin_prefetch(node)
+#else
+#define AVL_PREFETCH(node) ((void)(node))
+#endif
 
-AVLNode* avl_delete(AVLNode* root, int data, AVLMetrics* metrics) { // delete
-    if (root == NULL) {
-        return root;
+// Group prefetching: each round moves every unfinished search in the group
+// down one level and prefetches the child it will read next round, so while
+// one search waits on memory the others make progress.
+void avl_search_batch(AVLNode* root, const int* keys, int count, AVLNode** results, int batch,
+                      AVLMetrics* metrics) {
+    AVLNode* current[AVL_BATCH_MAX];
+
+    if (batch < 1) {
+        batch = 1;
+    } else if (batch > AVL_BATCH_MAX) {
+        batch = AVL_BATCH_MAX;
     }
-    
-    metrics->comparisons++;
-    
-    if (data < root->data) { // peform bst standard deletion
-        root->left = avl_delete(root->left, data, metrics);
-    } else if (data > root->data) {
-        root->right = avl_delete(root->right, data, metrics);
-    } else {
-        if ((root->left == NULL) || (root->right == NULL)) {
-            AVLNode* temp = root->left ? root->left : root->right;
-            
-            if (temp == NULL) {
-                temp = root;
-                root = NULL;
-            } else {
-                *root = *temp;
+
+    for (int base = 0; base < count; base += batch) {
+        int group = count - base < batch ? count - base : batch;
+        int active = group;
+
+        for (int i = 0; i < group; i++) {
+            current[i] = root;
+            results[base + i] = NULL;
+        }
+        if (root == NULL) {
+            continue;
+        }
+
+        while (active > 0) {
+            for (int i = 0; i < group; i++) {
+                AVLNode* node = current[i];
+                if (node == NULL) { // finished earlier
+                    continue;
+                }
+
+                METRIC_INC(metrics, comparisons);
+                int data = keys[base + i];
+                if (data == node->data) {
+                    results[base + i] = node;
+                    node = NULL;
+                } else {
+                    node = data < node->data ? node->left : node->right;
+                }
+
+                current[i] = node;
+                if (node != NULL) {
+                    AVL_PREFETCH(node);
+                } else {
+                    active--;
+                }
             }
-            free(temp);
-        } else {
-            AVLNode* temp = minValueNode(root->right);
-            root->data = temp->data;
-            root->right = avl_delete(root->right, temp->data, metrics);
         }
     }
-    
-    if (root == NULL) {
-        return root;
-    }
-    
+}
+
+static AVLNode* rebalance(AVLNode* root, AVLMetrics* metrics) { // after a removal below root
     root->height = 1 + maxHeight(height(root->left), height(root->right)); // update height
+    updateSize(root);
     
     int balance = getBalance(root); // get balance factor
     
 
     if (balance > 1 && getBalance(root->left) >= 0) { // different cases
+        METRIC_INC(metrics, ll_rotations);
         return rightRotate(root, metrics);
     }
     
     if (balance > 1 && getBalance(root->left) < 0) {
+        METRIC_INC(metrics, lr_rotations);
         root->left = leftRotate(root->left, metrics);
         return rightRotate(root, metrics);
     }
     
     if (balance < -1 && getBalance(root->right) <= 0) {
+        METRIC_INC(metrics, rr_rotations);
         return leftRotate(root, metrics);
     }
 
     if (balance < -1 && getBalance(root->right) > 0) {
+        METRIC_INC(metrics, rl_rotations);
         root->right = rightRotate(root->right, metrics);
         return leftRotate(root, metrics);
     }
@@ -188,6 +300,66 @@ AVLNode* avl_delete(AVLNode* root, int data, AVLMetrics* metrics) { // delete
     return root;
 }
 
+// unlinks the smallest node of a subtree without freeing it, returns the new subtree root
+static AVLNode* detachMin(AVLNode* root, AVLNode** min, AVLMetrics* metrics RETRACE_PARAM) {
+    if (root->left == NULL) {
+        *min = root;
+        RETRACE_START(metrics);
+        return root->right;
+    }
+    RETRACE_SAVE(root);
+    root->left = detachMin(root->left, min, metrics RETRACE_ARG);
+    root = rebalance(root, metrics);
+    RETRACE_STEP(root, metrics);
+    return root;
+}
+
+static AVLNode* deleteNode(AVLNode* root, int data, AVLMetrics* metrics RETRACE_PARAM) {
+    if (root == NULL) {
+        return root;
+    }
+    
+    METRIC_INC(metrics, comparisons);
+    RETRACE_SAVE(root);
+    
+    if (data < root->data) { // peform bst standard deletion
+        root->left = deleteNode(root->left, data, metrics RETRACE_ARG);
+    } else if (data > root->data) {
+        root->right = deleteNode(root->right, data, metrics RETRACE_ARG);
+    } else {
+        if ((root->left == NULL) || (root->right == NULL)) { // the child (a leaf, or nothing) takes its place
+            AVLNode* child = root->left ? root->left : root->right;
+            releaseAVLNode(root);
+            RETRACE_START(metrics);
+            return child;
+        }
+        
+        AVLNode* successor; // two children: the successor node moves up into this position
+        AVLNode* right = detachMin(root->right, &successor, metrics RETRACE_ARG);
+        successor->left = root->left;
+        successor->right = right;
+        releaseAVLNode(root);
+        root = successor;
+    }
+    
+    root = rebalance(root, metrics);
+    RETRACE_STEP(root, metrics);
+    return root;
+}
+
+// Nodes are relinked, never copied: a node returned by avl_search keeps its key
+// and stays valid until that key itself is deleted.
+AVLNode* avl_delete(AVLNode* root, int data, AVLMetrics* metrics) { // delete
+#if TREE_METRICS
+    int retrace = -1;
+    root = deleteNode(root, data, metrics, &retrace);
+    retraceFinish(retrace, metrics);
+    return root;
+#else
+    return deleteNode(root, data, metrics);
+#endif
+}
+
 int avl_height(AVLNode* root) {
     return height(root);
 }
@@ -200,10 +372,292 @@ void avl_inorder(AVLNode* root) { // inorder traversal
     }
 }
 
+static void avlDumpToBuffer(AVLNode* root, DumpBuffer* out) {
+    if (root != NULL) {
+        avlDumpToBuffer(root->left, out);
+        dump_int(out, root->data);
+        avlDumpToBuffer(root->right, out);
+    }
+}
+
+size_t avl_inorder_buffer(AVLNode* root, char* buffer, size_t capacity) {
+    DumpBuffer out;
+    dump_init(&out, buffer, capacity);
+    avlDumpToBuffer(root, &out);
+    return dump_finish(&out);
+}
+
+static void avlDumpToOutput(AVLNode* root, OutputBuffer* out) {
+    if (root != NULL) {
+        avlDumpToOutput(root->left, out);
+        output_int(out, root->data);
+        avlDumpToOutput(root->right, out);
+    }
+}
+
+void avl_inorder_fd(AVLNode* root, int fd) {
+    OutputBuffer* out = (OutputBuffer*)malloc(sizeof(OutputBuffer));
+    if (out == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    output_init(out, fd);
+    avlDumpToOutput(root, out);
+    output_flush(out);
+    free(out);
+}
+
 void freeAVL(AVLNode* root) { // free memory
     if (root != NULL) {
         freeAVL(root->left);
         freeAVL(root->right);
-        free(root);
+        releaseAVLNode(root);
     }
-}
\ No newline at end of file
+}
+
+AVLNode* avl_build_sorted(const int* keys, int n) { // middle key at the root, halves below
+    if (n <= 0) {
+        return NULL;
+    }
+
+    int mid = n / 2;
+    AVLNode* root = createAVLNode(keys[mid]);
+    root->left = avl_build_sorted(keys, mid);
+    root->right = avl_build_sorted(keys + mid + 1, n - mid - 1);
+    root->height = maxHeight(height(root->left), height(root->right)) + 1; // sides differ by at most one key
+#if AVL_ORDER_STATS
+    root->size = n;
+#endif
+    return root;
+}
+
+static int countNodes(AVLNode* root) {
+    if (root == NULL) {
+        return 0;
+    }
+    return countNodes(root->left) + countNodes(root->right) + 1;
+}
+
+static int orderPreorder(AVLNode* node, AVLNode** order, int next) {
+    if (node != NULL) {
+        order[next++] = node;
+        next = orderPreorder(node->left, order, next);
+        next = orderPreorder(node->right, order, next);
+    }
+    return next;
+}
+
+static int orderVEB(AVLNode* node, int levels, AVLNode** order, int next);
+
+// lays out, left to right, every subtree rooted depth levels below node
+static int orderBelow(AVLNode* node, int depth, int levels, AVLNode** order, int next) {
+    if (node == NULL) {
+        return next;
+    }
+    if (depth == 0) {
+        return orderVEB(node, levels, order, next);
+    }
+    next = orderBelow(node->left, depth - 1, levels, order, next);
+    return orderBelow(node->right, depth - 1, levels, order, next);
+}
+
+static int orderVEB(AVLNode* node, int levels, AVLNode** order, int next) {
+    if (node == NULL) {
+        return next;
+    }
+    if (levels <= 1) {
+        order[next++] = node;
+        return next;
+    }
+
+    int topLevels = levels / 2;
+    next = orderVEB(node, topLevels, order, next);
+    return orderBelow(node, topLevels, levels - topLevels, order, next);
+}
+
+AVLNode* avl_compact(AVLNode* root, NodeArena* target, AVLCompactOrder order) {
+    int n = countNodes(root);
+    if (n == 0) {
+        return NULL;
+    }
+
+    AVLNode** oldNodes = (AVLNode**)malloc(n * sizeof(AVLNode*));
+    AVLNode** newNodes = (AVLNode**)malloc(n * sizeof(AVLNode*));
+    if (oldNodes == NULL || newNodes == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+
+    if (order == AVL_COMPACT_VEB) {
+        orderVEB(root, root->height, oldNodes, 0);
+    } else {
+        orderPreorder(root, oldNodes, 0);
+    }
+
+    for (int i = 0; i < n; i++) { // copies land next to each other; children still old
+        newNodes[i] = (AVLNode*)arena_alloc(target);
+        *newNodes[i] = *oldNodes[i];
+    }
+    for (int i = 0; i < n; i++) { // old node's left now forwards to its copy
+        oldNodes[i]->left = newNodes[i];
+    }
+    for (int i = 0; i < n; i++) {
+        AVLNode* copy = newNodes[i];
+        copy->left = copy->left != NULL ? copy->left->left : NULL;
+        copy->right = copy->right != NULL ? copy->right->left : NULL;
+    }
+
+    AVLNode* newRoot = root->left; // forwarded like every other node
+    for (int i = 0; i < n; i++) {
+        releaseAVLNode(oldNodes[i]);
+    }
+    free(newNodes);
+    free(oldNodes);
+    return newRoot;
+}
+
+// cursors never allocate: the path array is sized for the tallest possible avl tree
+static void cursorPushLeft(AVLCursor* cursor, AVLNode* node) {
+    while (node != NULL) {
+        cursor->path[cursor->depth++] = node;
+        node = node->left;
+    }
+}
+
+static void cursorPushRight(AVLCursor* cursor, AVLNode* node) {
+    while (node != NULL) {
+        cursor->path[cursor->depth++] = node;
+        node = node->right;
+    }
+}
+
+void avl_cursor_first(AVLCursor* cursor, AVLNode* root) {
+    cursor->depth = 0;
+    cursorPushLeft(cursor, root);
+}
+
+void avl_cursor_last(AVLCursor* cursor, AVLNode* root) {
+    cursor->depth = 0;
+    cursorPushRight(cursor, root);
+}
+
+void avl_cursor_seek(AVLCursor* cursor, AVLNode* root, int data) { // lower bound
+    int found = 0; // path length up to the best candidate so far
+    cursor->depth = 0;
+
+    while (root != NULL) {
+        cursor->path[cursor->depth++] = root;
+        if (data <= root->data) {
+            found = cursor->depth;
+            if (data == root->data) {
+                break;
+            }
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
+    cursor->depth = found;
+}
+
+int avl_cursor_valid(AVLCursor* cursor) {
+    return cursor->depth > 0;
+}
+
+AVLNode* avl_cursor_node(AVLCursor* cursor) {
+    if (cursor->depth == 0) {
+        return NULL;
+    }
+    return cursor->path[cursor->depth - 1];
+}
+
+void avl_cursor_next(AVLCursor* cursor) {
+    if (cursor->depth == 0) {
+        return;
+    }
+
+    AVLNode* node = cursor->path[cursor->depth - 1];
+    if (node->right != NULL) { // leftmost of the right subtree
+        cursorPushLeft(cursor, node->right);
+        return;
+    }
+
+    do { // climb until we leave a left subtree
+        node = cursor->path[--cursor->depth];
+    } while (cursor->depth > 0 && cursor->path[cursor->depth - 1]->right == node);
+}
+
+void avl_cursor_prev(AVLCursor* cursor) {
+    if (cursor->depth == 0) {
+        return;
+    }
+
+    AVLNode* node = cursor->path[cursor->depth - 1];
+    if (node->left != NULL) { // rightmost of the left subtree
+        cursorPushRight(cursor, node->left);
+        return;
+    }
+
+    do {
+        node = cursor->path[--cursor->depth];
+    } while (cursor->depth > 0 && cursor->path[cursor->depth - 1]->left == node);
+}
+
+void avl_range_visit(AVLNode* root, int lo, int hi, AVLVisitor visit, void* context) {
+    if (root == NULL) {
+        return;
+    }
+    if (lo < root->data) { // skip subtrees that lie entirely outside [lo, hi]
+        avl_range_visit(root->left, lo, hi, visit, context);
+    }
+    if (lo <= root->data && root->data <= hi) {
+        visit(root, context);
+    }
+    if (root->data < hi) {
+        avl_range_visit(root->right, lo, hi, visit, context);
+    }
+}
+
+#if AVL_ORDER_STATS
+// keys below data (or at most data when inclusive), one root-to-leaf descent
+static int countBelow(AVLNode* root, int data, int inclusive, AVLMetrics* metrics) {
+    int count = 0;
+    while (root != NULL) {
+        METRIC_INC(metrics, comparisons);
+        if (data < root->data || (!inclusive && data == root->data)) {
+            root = root->left;
+        } else {
+            count += subtreeSize(root->left) + 1;
+            root = root->right;
+        }
+    }
+    return count;
+}
+
+int avl_rank(AVLNode* root, int data, AVLMetrics* metrics) {
+    return countBelow(root, data, 0, metrics);
+}
+
+AVLNode* avl_select(AVLNode* root, int k, AVLMetrics* metrics) { // NULL when k is out of range
+    while (root != NULL) {
+        METRIC_INC(metrics, comparisons);
+        int leftSize = subtreeSize(root->left);
+        if (k < leftSize) {
+            root = root->left;
+        } else if (k == leftSize) {
+            return root;
+        } else {
+            k -= leftSize + 1;
+            root = root->right;
+        }
+    }
+    return NULL;
+}
+
+int avl_count_range(AVLNode* root, int lo, int hi, AVLMetrics* metrics) {
+    if (lo > hi) {
+        return 0;
+    }
+    return countBelow(root, hi, 1, metrics) - countBelow(root, lo, 0, metrics);
+}
+#endif
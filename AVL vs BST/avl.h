@@ -1,28 +1,99 @@
 #ifndef AVL_H
 #define AVL_H
 
+#include <stddef.h>
 #include <time.h>
+#include "metrics.h"
+#include "arena.h"
+
+#ifdef __cplusplus // usable from the c++ coroutine front end
+extern "C" {
+#endif
+
+#ifndef AVL_ORDER_STATS // subtree sizes for rank/select, build with -DAVL_ORDER_STATS=0 to drop them
+#define AVL_ORDER_STATS 1
+#endif
 
 typedef struct AVLNode { // avl node struc
     int data;
     int height;
+#if AVL_ORDER_STATS
+    int size; // nodes in this subtree
+#endif
     struct AVLNode *left;
     struct AVLNode *right;
 } AVLNode;
 
+#define AVL_MAX_HEIGHT 64 // 1.44 log2(n) stays below this for any int key set
+#define AVL_BATCH_MAX 64  // lookups interleaved by avl_search_batch
+
+typedef struct { // in-order cursor, path from the root to the current node
+    AVLNode* path[AVL_MAX_HEIGHT];
+    int depth; // 0 means past the end
+} AVLCursor;
+
+typedef void (*AVLVisitor)(AVLNode* node, void* context);
+
 typedef struct { // metrics
     long comparisons;
-    long rotations;
+    long rotations; // single rotations, a double-rotation case adds 2
     double time_taken;
     int final_height;
+    long ll_rotations; // rebalancing cases, one per imbalance fixed
+    long rr_rotations;
+    long lr_rotations;
+    long rl_rotations;
+    long retrace_ops;   // inserts and deletes that changed the tree
+    long retrace_steps; // ancestors revisited until the height change was absorbed
+    long stop_level[AVL_MAX_HEIGHT]; // updates whose change grew or shrank k ancestors before it stopped
 } AVLMetrics;
 
 AVLNode* createAVLNode(int data);
+// nodes created on this thread come from arena (NULL: malloc) until changed;
+// free a tree with the same arena selected that it was built under
+void avl_use_arena(NodeArena* arena);
+
+typedef enum { // node order written by avl_compact
+    AVL_COMPACT_DFS, // preorder: a node, then its left subtree, then its right
+    AVL_COMPACT_VEB  // van Emde Boas: top half of the levels, then each bottom subtree
+} AVLCompactOrder;
+
+// Stop-the-world relocation: copies every node into target in the given order
+// and returns the new root. The old nodes are freed as they would be by
+// avl_delete, so call it with the arena the tree was built under still
+// selected, then switch to target with avl_use_arena.
+AVLNode* avl_compact(AVLNode* root, NodeArena* target, AVLCompactOrder order);
 AVLNode* avl_insert(AVLNode* root, int data, AVLMetrics* metrics);
 AVLNode* avl_search(AVLNode* root, int data, AVLMetrics* metrics);
+// looks up count keys, results[i] is the node for keys[i] or NULL; up to batch
+// (1..AVL_BATCH_MAX) searches advance together so their cache misses overlap
+void avl_search_batch(AVLNode* root, const int* keys, int count, AVLNode** results, int batch,
+                      AVLMetrics* metrics);
 AVLNode* avl_delete(AVLNode* root, int data, AVLMetrics* metrics);
 int avl_height(AVLNode* root);
 void avl_inorder(AVLNode* root);
+size_t avl_inorder_buffer(AVLNode* root, char* buffer, size_t capacity); // like snprintf: NUL-terminated, returns full length
+void avl_inorder_fd(AVLNode* root, int fd); // buffered write(2), same text as avl_inorder
 void freeAVL(AVLNode* root);
+AVLNode* avl_build_sorted(const int* keys, int n); // perfectly balanced tree from strictly ascending keys, O(n)
+
+void avl_cursor_first(AVLCursor* cursor, AVLNode* root);
+void avl_cursor_last(AVLCursor* cursor, AVLNode* root);
+void avl_cursor_seek(AVLCursor* cursor, AVLNode* root, int data); // first key >= data
+int avl_cursor_valid(AVLCursor* cursor);
+AVLNode* avl_cursor_node(AVLCursor* cursor);
+void avl_cursor_next(AVLCursor* cursor);
+void avl_cursor_prev(AVLCursor* cursor);
+void avl_range_visit(AVLNode* root, int lo, int hi, AVLVisitor visit, void* context); // keys in [lo, hi], ascending
+
+#if AVL_ORDER_STATS
+int avl_rank(AVLNode* root, int data, AVLMetrics* metrics); // keys smaller than data
+AVLNode* avl_select(AVLNode* root, int k, AVLMetrics* metrics); // k-th smallest, 0-based
+int avl_count_range(AVLNode* root, int lo, int hi, AVLMetrics* metrics); // keys in [lo, hi]
+#endif
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
\ No newline at end of file
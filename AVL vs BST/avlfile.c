@@ -0,0 +1,84 @@
+#define _POSIX_C_SOURCE 200112L // fstat, fileno
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include "avlfile.h"
+
+#define AVL_FILE_CHUNK 4096 // keys per fwrite
+
+int avl_save(AVLNode* root, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return -1;
+    }
+
+    AVLFileHeader header = {AVL_FILE_MAGIC, AVL_FILE_VERSION, sizeof(int), 0, 0};
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1; // count is patched in at the end
+
+    int chunk[AVL_FILE_CHUNK];
+    int filled = 0;
+    AVLCursor cursor;
+    for (avl_cursor_first(&cursor, root); ok && avl_cursor_valid(&cursor); avl_cursor_next(&cursor)) {
+        chunk[filled++] = avl_cursor_node(&cursor)->data;
+        header.count++;
+        if (filled == AVL_FILE_CHUNK) {
+            ok = fwrite(chunk, sizeof(int), filled, file) == (size_t)filled;
+            filled = 0;
+        }
+    }
+    if (ok && filled > 0) {
+        ok = fwrite(chunk, sizeof(int), filled, file) == (size_t)filled;
+    }
+
+    if (ok) {
+        ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+    if (fclose(file) != 0) {
+        ok = 0;
+    }
+    return ok ? (int)header.count : -1;
+}
+
+int avl_load(const char* path, AVLNode** root) {
+    *root = NULL;
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+
+    AVLFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != AVL_FILE_MAGIC ||
+        header.version != AVL_FILE_VERSION || header.key_size != sizeof(int) ||
+        header.count > (uint64_t)INT32_MAX) {
+        fclose(file);
+        return -1;
+    }
+
+    struct stat info; // the count must match the file before it sizes an allocation
+    if (fstat(fileno(file), &info) != 0 || info.st_size < (off_t)sizeof(header) ||
+        (uint64_t)(info.st_size - sizeof(header)) / sizeof(int) != header.count ||
+        (uint64_t)(info.st_size - sizeof(header)) % sizeof(int) != 0) {
+        fclose(file);
+        return -1;
+    }
+
+    int n = (int)header.count;
+    int* keys = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    if (keys == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+
+    int ok = fread(keys, sizeof(int), n, file) == (size_t)n;
+    for (int i = 1; ok && i < n; i++) { // a balanced build of unsorted keys would not be a search tree
+        ok = keys[i - 1] < keys[i];
+    }
+    fclose(file);
+
+    if (ok) {
+        *root = avl_build_sorted(keys, n);
+    }
+    free(keys);
+    return ok ? n : -1;
+}
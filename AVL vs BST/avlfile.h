@@ -0,0 +1,26 @@
+#ifndef AVLFILE_H
+#define AVLFILE_H
+
+#include <stdint.h>
+#include "avl.h"
+
+// Compact on-disk form of an AVL tree: a fixed header followed by the keys in
+// ascending order as raw native ints. Loading rebuilds a perfectly balanced
+// tree with avl_build_sorted, O(n) with no comparisons or rotations, instead
+// of n avl_insert calls.
+
+#define AVL_FILE_MAGIC 0x4b4c5641u // "AVLK" when read back in the same byte order
+#define AVL_FILE_VERSION 1
+
+typedef struct { // 24 bytes, keys follow immediately
+    uint32_t magic;
+    uint32_t version;
+    uint32_t key_size; // sizeof(int) of the writer
+    uint32_t reserved;
+    uint64_t count;
+} AVLFileHeader;
+
+int avl_save(AVLNode* root, const char* path); // returns keys written, -1 on i/o error
+int avl_load(const char* path, AVLNode** root); // returns keys read, -1 on i/o error or a bad file
+
+#endif
@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "avlimage.h"
+
+static uint32_t countImageNodes(AVLNode* root) {
+    if (root == NULL) {
+        return 0;
+    }
+    return countImageNodes(root->left) + countImageNodes(root->right) + 1;
+}
+
+// preorder: a node's index is taken before its subtrees, so the root is node 0
+static uint32_t fillImage(AVLNode* root, AVLImageNode* nodes, uint32_t* next) {
+    if (root == NULL) {
+        return AVL_IMAGE_NULL;
+    }
+
+    uint32_t index = (*next)++;
+    nodes[index].data = root->data;
+    nodes[index].height = root->height;
+    nodes[index].left = fillImage(root->left, nodes, next);
+    nodes[index].right = fillImage(root->right, nodes, next);
+    return index;
+}
+
+int avl_image_write(AVLNode* root, const char* path) {
+    uint32_t count = countImageNodes(root);
+    AVLImageNode* nodes = (AVLImageNode*)malloc((count > 0 ? count : 1) * sizeof(AVLImageNode));
+    if (nodes == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+
+    uint32_t next = 0;
+    AVLImageHeader header = {AVL_IMAGE_MAGIC, AVL_IMAGE_VERSION, sizeof(AVLImageNode),
+                             fillImage(root, nodes, &next), count};
+
+    FILE* file = fopen(path, "wb");
+    int ok = file != NULL;
+    if (ok) {
+        ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(nodes, sizeof(AVLImageNode), count, file) == count;
+        if (fclose(file) != 0) {
+            ok = 0;
+        }
+    }
+    free(nodes);
+    return ok ? (int)count : -1;
+}
+
+int avl_image_open(AVLImage* image, const char* path) {
+    image->base = NULL;
+    image->length = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(AVLImageHeader)) {
+        close(fd);
+        return 0;
+    }
+
+    void* base = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (base == MAP_FAILED) {
+        return 0;
+    }
+
+    const AVLImageHeader* header = (const AVLImageHeader*)base;
+    int ok = header->magic == AVL_IMAGE_MAGIC && header->version == AVL_IMAGE_VERSION &&
+             header->node_size == sizeof(AVLImageNode) &&
+             header->count <= (info.st_size - sizeof(AVLImageHeader)) / sizeof(AVLImageNode) &&
+             (header->root == AVL_IMAGE_NULL ? header->count == 0 : header->root < header->count);
+    if (!ok) {
+        munmap(base, info.st_size);
+        return 0;
+    }
+
+    image->base = base;
+    image->length = info.st_size;
+    image->nodes = (const AVLImageNode*)(header + 1);
+    image->root = header->root;
+    image->count = header->count;
+    return 1;
+}
+
+// same walk as avl_search, following indices instead of pointers; child
+// indices are trusted, the file is assumed to come from avl_image_write
+const AVLImageNode* avl_image_search(const AVLImage* image, int data, AVLMetrics* metrics) {
+    uint32_t index = image->root;
+
+    while (index != AVL_IMAGE_NULL) {
+        const AVLImageNode* node = &image->nodes[index];
+        METRIC_INC(metrics, comparisons);
+
+        if (data == node->data) {
+            return node;
+        }
+        index = data < node->data ? node->left : node->right;
+    }
+    return NULL;
+}
+
+void avl_image_close(AVLImage* image) {
+    if (image->base != NULL) {
+        munmap(image->base, image->length);
+        image->base = NULL;
+    }
+}
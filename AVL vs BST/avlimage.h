@@ -0,0 +1,45 @@
+#ifndef AVLIMAGE_H
+#define AVLIMAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "avl.h"
+
+// Pointer-free AVL tree image. Nodes live in one array in preorder and refer
+// to their children by array index, so the file can be mmap'ed read-only and
+// searched in place: opening costs one mmap, no allocation or copying, and
+// pages are faulted in by the lookups that touch them.
+
+#define AVL_IMAGE_MAGIC 0x494c5641u // "AVLI" when read back in the same byte order
+#define AVL_IMAGE_VERSION 1
+#define AVL_IMAGE_NULL UINT32_MAX // no child
+
+typedef struct { // 16 bytes vs 32 for AVLNode
+    int32_t data;
+    int32_t height;
+    uint32_t left; // child indices into the node array
+    uint32_t right;
+} AVLImageNode;
+
+typedef struct { // 24 bytes, node array follows immediately
+    uint32_t magic;
+    uint32_t version;
+    uint32_t node_size; // sizeof(AVLImageNode) of the writer
+    uint32_t root;      // AVL_IMAGE_NULL for an empty tree
+    uint64_t count;
+} AVLImageHeader;
+
+typedef struct { // an open, mapped image
+    void* base;
+    size_t length;
+    const AVLImageNode* nodes;
+    uint32_t root;
+    uint64_t count;
+} AVLImage;
+
+int avl_image_write(AVLNode* root, const char* path); // returns nodes written, -1 on i/o error
+int avl_image_open(AVLImage* image, const char* path); // 1 on success, 0 on i/o error or a bad file
+const AVLImageNode* avl_image_search(const AVLImage* image, int data, AVLMetrics* metrics);
+void avl_image_close(AVLImage* image);
+
+#endif
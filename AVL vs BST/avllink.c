@@ -0,0 +1,169 @@
+#include "avllink.h"
+
+// Iterative: the descent records every child slot it passes (AVL_MAX_HEIGHT
+// of them at most) and retracing walks that path stack back up, stopping as
+// soon as a subtree comes out the same height it went in.
+
+static int linkHeight(AVLLink* link) {
+    return link == NULL ? 0 : link->height;
+}
+
+static void updateLinkHeight(AVLLink* link) {
+    int leftHeight = linkHeight(link->left);
+    int rightHeight = linkHeight(link->right);
+    link->height = (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+}
+
+static AVLLink* rotateLinkRight(AVLLink* y, AVLMetrics* metrics) {
+    AVLLink* x = y->left;
+    y->left = x->right;
+    x->right = y;
+    updateLinkHeight(y);
+    updateLinkHeight(x);
+    METRIC_INC(metrics, rotations);
+    return x;
+}
+
+static AVLLink* rotateLinkLeft(AVLLink* x, AVLMetrics* metrics) {
+    AVLLink* y = x->right;
+    x->right = y->left;
+    y->left = x;
+    updateLinkHeight(x);
+    updateLinkHeight(y);
+    METRIC_INC(metrics, rotations);
+    return y;
+}
+
+static AVLLink* rebalanceLink(AVLLink* link, AVLMetrics* metrics) { // heights below are already right
+    updateLinkHeight(link);
+    int balance = linkHeight(link->left) - linkHeight(link->right);
+
+    if (balance > 1) {
+        if (linkHeight(link->left->left) < linkHeight(link->left->right)) { // left-right
+            METRIC_INC(metrics, lr_rotations);
+            link->left = rotateLinkLeft(link->left, metrics);
+        } else {
+            METRIC_INC(metrics, ll_rotations);
+        }
+        return rotateLinkRight(link, metrics);
+    }
+    if (balance < -1) {
+        if (linkHeight(link->right->right) < linkHeight(link->right->left)) { // right-left
+            METRIC_INC(metrics, rl_rotations);
+            link->right = rotateLinkRight(link->right, metrics);
+        } else {
+            METRIC_INC(metrics, rr_rotations);
+        }
+        return rotateLinkLeft(link, metrics);
+    }
+    return link;
+}
+
+static void retrace(AVLLink** path[], int depth, AVLMetrics* metrics) { // path[0..depth-1] hold changed subtrees
+    int changed = 0; // ancestors whose height moved, for AVLMetrics.stop_level
+    METRIC_INC(metrics, retrace_ops);
+    while (depth-- > 0) {
+        AVLLink* link = *path[depth];
+        int before = link->height;
+        METRIC_INC(metrics, retrace_steps);
+        *path[depth] = rebalanceLink(link, metrics);
+        if ((*path[depth])->height == before) { // nothing above can change
+            break;
+        }
+        changed++;
+    }
+    METRIC_INC(metrics, stop_level[changed]);
+}
+
+void avl_link_init(AVLLinkTree* tree, AVLLinkCompare compare) {
+    tree->root = NULL;
+    tree->compare = compare;
+}
+
+AVLLink* avl_link_insert(AVLLinkTree* tree, AVLLink* link, AVLMetrics* metrics) {
+    AVLLink** path[AVL_MAX_HEIGHT];
+    AVLLink** slot = &tree->root;
+    int depth = 0;
+
+    while (*slot != NULL) {
+        METRIC_INC(metrics, comparisons);
+        int order = tree->compare(link, *slot);
+        if (order == 0) {
+            return *slot;
+        }
+        path[depth++] = slot;
+        slot = order < 0 ? &(*slot)->left : &(*slot)->right;
+    }
+
+    link->left = NULL;
+    link->right = NULL;
+    link->height = 1;
+    *slot = link;
+    retrace(path, depth, metrics);
+    return NULL;
+}
+
+AVLLink* avl_link_find(AVLLinkTree* tree, const AVLLink* probe, AVLMetrics* metrics) {
+    AVLLink* link = tree->root;
+    while (link != NULL) {
+        METRIC_INC(metrics, comparisons);
+        int order = tree->compare(probe, link);
+        if (order == 0) {
+            return link;
+        }
+        link = order < 0 ? link->left : link->right;
+    }
+    return NULL;
+}
+
+AVLLink* avl_link_remove(AVLLinkTree* tree, const AVLLink* probe, AVLMetrics* metrics) {
+    AVLLink** path[AVL_MAX_HEIGHT];
+    AVLLink** slot = &tree->root;
+    int depth = 0;
+
+    while (*slot != NULL) {
+        METRIC_INC(metrics, comparisons);
+        int order = tree->compare(probe, *slot);
+        if (order == 0) {
+            break;
+        }
+        path[depth++] = slot;
+        slot = order < 0 ? &(*slot)->left : &(*slot)->right;
+    }
+
+    AVLLink* victim = *slot;
+    if (victim == NULL) {
+        return NULL;
+    }
+
+    if (victim->left == NULL || victim->right == NULL) { // the child takes its place
+        *slot = victim->left ? victim->left : victim->right;
+    } else { // the successor link moves into its place
+        int victimDepth = depth;
+        path[depth++] = slot;
+        AVLLink** successorSlot = &victim->right;
+        while ((*successorSlot)->left != NULL) {
+            path[depth++] = successorSlot;
+            successorSlot = &(*successorSlot)->left;
+        }
+
+        AVLLink* successor = *successorSlot;
+        *successorSlot = successor->right;
+        successor->left = victim->left;
+        successor->right = victim->right;
+        successor->height = victim->height;
+        *slot = successor;
+        if (depth > victimDepth + 1) { // the slot below the victim now belongs to the successor
+            path[victimDepth + 1] = &successor->right;
+        }
+    }
+
+    retrace(path, depth, metrics);
+    victim->left = NULL;
+    victim->right = NULL;
+    return victim;
+}
+
+int avl_link_height(AVLLinkTree* tree) {
+    return linkHeight(tree->root);
+}
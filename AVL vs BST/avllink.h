@@ -0,0 +1,50 @@
+#ifndef AVLLINK_H
+#define AVLLINK_H
+
+#include <stddef.h>
+#include "avl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Intrusive AVL tree in the style of the Linux rbtree: the caller embeds an
+// AVLLink in its own record and the tree only ever links those, so insert and
+// remove never allocate. Keys live in the records; compare(a, b) orders two
+// links and returns <0, 0 or >0, and avl_link_entry gets the record back.
+//
+//   typedef struct { int id; AVLLink link; char name[32]; } Record;
+//   Record* r = avl_link_entry(found, Record, link);
+//
+// Lookups and removals take a probe link embedded in a record that carries
+// just the key. The tree does no memory management; a record must stay put
+// while it is linked.
+
+typedef struct AVLLink {
+    struct AVLLink *left;
+    struct AVLLink *right;
+    int height; // of the subtree, a lone link is 1
+} AVLLink;
+
+typedef int (*AVLLinkCompare)(const AVLLink* a, const AVLLink* b);
+
+typedef struct {
+    AVLLink* root;
+    AVLLinkCompare compare;
+} AVLLinkTree;
+
+#define avl_link_entry(ptr, type, member) ((type*)((char*)(ptr) - offsetof(type, member)))
+
+void avl_link_init(AVLLinkTree* tree, AVLLinkCompare compare);
+// links it in and returns NULL, or returns the link already holding an equal key
+AVLLink* avl_link_insert(AVLLinkTree* tree, AVLLink* link, AVLMetrics* metrics);
+AVLLink* avl_link_find(AVLLinkTree* tree, const AVLLink* probe, AVLMetrics* metrics);
+// unlinks the link equal to probe and returns it (NULL if absent); its record is the caller's again
+AVLLink* avl_link_remove(AVLLinkTree* tree, const AVLLink* probe, AVLMetrics* metrics);
+int avl_link_height(AVLLinkTree* tree);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
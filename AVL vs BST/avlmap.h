@@ -0,0 +1,21 @@
+#ifndef AVLMAP_H
+#define AVLMAP_H
+
+#include "generic_tree.h"
+
+// Sorted int-keyed maps built from the generic AVL. AVLMapNode keeps the value
+// inline in the node (AVL_MAP_VALUE_SIZE bytes, set at compile time), while
+// AVLHandleMapNode stores a caller-owned pointer for large or shared records.
+
+#ifndef AVL_MAP_VALUE_SIZE
+#define AVL_MAP_VALUE_SIZE 16
+#endif
+
+typedef struct { // inline payload, copied in and out by value
+    unsigned char bytes[AVL_MAP_VALUE_SIZE];
+} MapValue;
+
+DEFINE_GENERIC_AVL(AVLMapNode, avlmap, int, MapValue, GENERIC_LESS, GENERIC_EQUAL)
+DEFINE_GENERIC_AVL(AVLHandleMapNode, handlemap, int, void*, GENERIC_LESS, GENERIC_EQUAL)
+
+#endif
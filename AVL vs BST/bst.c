@@ -1,10 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "bst.h"
+#include "memtrack.h"
+#include "output.h"
 
 
 BSTNode* createBSTNode(int data) { // create a new BST node
-    BSTNode* newNode = (BSTNode*)malloc(sizeof(BSTNode));
+    BSTNode* newNode = (BSTNode*)tracked_malloc(sizeof(BSTNode));
     if (newNode == NULL) {
         printf("Memory allocation failed!\n");
         exit(1);
@@ -20,7 +22,7 @@ BSTNode* bst_insert(BSTNode* root, int data, Metrics* metrics) { // insert into
         return createBSTNode(data);
     }
     
-    metrics->comparisons++;
+    METRIC_INC(metrics, comparisons);
     
     if (data < root->data) {
         root->left = bst_insert(root->left, data, metrics);
@@ -36,7 +38,7 @@ BSTNode* bst_search(BSTNode* root, int data, Metrics* metrics) { // search
         return NULL;
     }
     
-    metrics->comparisons++;
+    METRIC_INC(metrics, comparisons);
     
     if (data == root->data) {
         return root;
@@ -59,7 +61,7 @@ BSTNode* bst_delete(BSTNode* root, int data, Metrics* metrics) { // deletion
         return NULL;
     }
     
-    metrics->comparisons++;
+    METRIC_INC(metrics, comparisons);
     
     if (data < root->data) {
         root->left = bst_delete(root->left, data, metrics);
@@ -69,11 +71,11 @@ BSTNode* bst_delete(BSTNode* root, int data, Metrics* metrics) { // deletion
         // node found - delete it
         if (root->left == NULL) {
             BSTNode* temp = root->right;
-            free(root);
+            tracked_free(root);
             return temp;
         } else if (root->right == NULL) {
             BSTNode* temp = root->left;
-            free(root);
+            tracked_free(root);
             return temp;
         }
         
@@ -105,10 +107,60 @@ void bst_inorder(BSTNode* root) { //inorder
     }
 }
 
+static void bstDumpToBuffer(BSTNode* root, DumpBuffer* out) {
+    if (root != NULL) {
+        bstDumpToBuffer(root->left, out);
+        dump_int(out, root->data);
+        bstDumpToBuffer(root->right, out);
+    }
+}
+
+size_t bst_inorder_buffer(BSTNode* root, char* buffer, size_t capacity) {
+    DumpBuffer out;
+    dump_init(&out, buffer, capacity);
+    bstDumpToBuffer(root, &out);
+    return dump_finish(&out);
+}
+
+static void bstDumpToOutput(BSTNode* root, OutputBuffer* out) {
+    if (root != NULL) {
+        bstDumpToOutput(root->left, out);
+        output_int(out, root->data);
+        bstDumpToOutput(root->right, out);
+    }
+}
+
+void bst_inorder_fd(BSTNode* root, int fd) {
+    OutputBuffer* out = (OutputBuffer*)malloc(sizeof(OutputBuffer));
+    if (out == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    output_init(out, fd);
+    bstDumpToOutput(root, out);
+    output_flush(out);
+    free(out);
+}
+
 void freeBST(BSTNode* root) { //free memory
     if (root != NULL) {
         freeBST(root->left);
         freeBST(root->right);
-        free(root);
+        tracked_free(root);
     }
-}
\ No newline at end of file
+}
+
+void bst_range_visit(BSTNode* root, int lo, int hi, BSTVisitor visit, void* context) { // pruned inorder
+    if (root == NULL) {
+        return;
+    }
+    if (lo < root->data) {
+        bst_range_visit(root->left, lo, hi, visit, context);
+    }
+    if (lo <= root->data && root->data <= hi) {
+        visit(root, context);
+    }
+    if (root->data < hi) {
+        bst_range_visit(root->right, lo, hi, visit, context);
+    }
+}
@@ -1,7 +1,9 @@
 #ifndef BST_H
 #define BST_H
 
+#include <stddef.h>
 #include <time.h>
+#include "metrics.h"
 
 typedef struct BSTNode { // BST Node Structure
     int data;
@@ -16,12 +18,17 @@ typedef struct { // performance metrics structure
     int final_height;
 } Metrics;
 
+typedef void (*BSTVisitor)(BSTNode* node, void* context);
+
 BSTNode* createBSTNode(int data); // function prototypes
 BSTNode* bst_insert(BSTNode* root, int data, Metrics* metrics);
 BSTNode* bst_search(BSTNode* root, int data, Metrics* metrics);
 BSTNode* bst_delete(BSTNode* root, int data, Metrics* metrics);
 int bst_height(BSTNode* root);
 void bst_inorder(BSTNode* root);
+size_t bst_inorder_buffer(BSTNode* root, char* buffer, size_t capacity); // like snprintf: NUL-terminated, returns full length
+void bst_inorder_fd(BSTNode* root, int fd); // buffered write(2), same text as bst_inorder
 void freeBST(BSTNode* root);
+void bst_range_visit(BSTNode* root, int lo, int hi, BSTVisitor visit, void* context); // keys in [lo, hi], ascending
 
 #endif
\ No newline at end of file
@@ -0,0 +1,213 @@
+// C++20 coroutine front end over the C AVL tree: every lookup is a coroutine
+// that prefetches the next AVLNode and suspends, and a scheduler round-robins
+// a group of in-flight lookups so their cache misses overlap. Compared against
+// plain avl_search and the hand-written avl_search_batch loop.
+//
+// Separate program (experiment.c has its own main):
+//   gcc -std=c11 -O2 -c arena.c avl.c dataset.c memtrack.c output.c
+//   g++ -std=c++20 -O2 coro_search.cpp arena.o avl.o dataset.o memtrack.o output.o -o coro_search
+//   ./coro_search [size] [lookups]
+
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "avl.h"
+#include "dataset.h"
+
+namespace {
+
+// Coroutine frames come from a free list instead of the heap: every lookup
+// frame has the same size, and malloc per lookup would swamp the savings.
+class FrameArena {
+public:
+    void* allocate(std::size_t size) {
+        if (size > slotSize) { // first frame fixes the slot size
+            if (freeList != nullptr) {
+                std::printf("Coroutine frame size changed!\n");
+                std::exit(1);
+            }
+            slotSize = size;
+        }
+        if (freeList == nullptr) {
+            void* slot = std::malloc(slotSize);
+            if (slot == nullptr) {
+                std::printf("Memory allocation failed!\n");
+                std::exit(1);
+            }
+            return slot;
+        }
+        FreeSlot* slot = freeList;
+        freeList = slot->next;
+        return slot;
+    }
+
+    void release(void* frame) {
+        FreeSlot* slot = static_cast<FreeSlot*>(frame);
+        slot->next = freeList;
+        freeList = slot;
+    }
+
+    ~FrameArena() {
+        while (freeList != nullptr) {
+            FreeSlot* next = freeList->next;
+            std::free(freeList);
+            freeList = next;
+        }
+    }
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+    FreeSlot* freeList = nullptr;
+    std::size_t slotSize = sizeof(FreeSlot);
+};
+
+thread_local FrameArena frameArena;
+
+struct Lookup { // one in-flight search, resumed by the scheduler
+    struct promise_type {
+        AVLNode* result = nullptr;
+
+        Lookup get_return_object() {
+            return Lookup{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_value(AVLNode* node) { result = node; }
+        void unhandled_exception() { std::abort(); }
+
+        static void* operator new(std::size_t size) { return frameArena.allocate(size); }
+        static void operator delete(void* frame) { frameArena.release(frame); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// same walk as avl_search; the suspension point sits between issuing the
+// prefetch and touching the node
+Lookup lookup(AVLNode* root, int key, AVLMetrics* metrics) {
+    AVLNode* node = root;
+    while (node != nullptr) {
+        __builtin_prefetch(node);
+        co_await std::suspend_always{};
+
+        METRIC_INC(metrics, comparisons);
+        if (key == node->data) {
+            co_return node;
+        }
+        node = key < node->data ? node->left : node->right;
+    }
+    co_return nullptr;
+}
+
+// keeps up to group lookups in flight; a finished slot takes the next key
+void searchInterleaved(AVLNode* root, const int* keys, int count, AVLNode** results, int group,
+                       AVLMetrics* metrics) {
+    std::vector<std::coroutine_handle<Lookup::promise_type>> slots(group);
+    std::vector<int> owner(group); // which key each slot is searching for
+    int next = 0;
+    int active = 0;
+
+    for (int s = 0; s < group && next < count; s++, next++, active++) {
+        slots[s] = lookup(root, keys[next], metrics).handle;
+        owner[s] = next;
+    }
+
+    while (active > 0) {
+        for (int s = 0; s < group; s++) {
+            if (!slots[s]) {
+                continue;
+            }
+            slots[s].resume();
+            if (!slots[s].done()) {
+                continue;
+            }
+
+            results[owner[s]] = slots[s].promise().result;
+            slots[s].destroy();
+            if (next < count) {
+                slots[s] = lookup(root, keys[next], metrics).handle;
+                owner[s] = next++;
+            } else {
+                slots[s] = nullptr;
+                active--;
+            }
+        }
+    }
+}
+
+double nowSeconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+long countHits(AVLNode** results, const int* queries, int lookups) {
+    long found = 0;
+    for (int i = 0; i < lookups; i++) {
+        found += results[i] != nullptr && results[i]->data == queries[i];
+    }
+    return found;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int size = argc > 1 ? std::atoi(argv[1]) : 4000000;
+    int lookups = argc > 2 ? std::atoi(argv[2]) : 2000000;
+    int groups[] = {1, 2, 4, 8, 16, 32, 64};
+
+    std::vector<int> keys(size);
+    std::vector<int> queries(lookups);
+    std::vector<AVLNode*> results(lookups);
+
+    generateSortedData(keys.data(), size);
+    shuffleArray(keys.data(), size); // random insertion order scatters the nodes over the heap
+    for (int i = 0; i < lookups; i++) {
+        queries[i] = std::rand() % (size + size / 4) + 1; // about 20% misses
+    }
+
+    AVLMetrics metrics = {};
+    AVLNode* root = nullptr;
+    for (int i = 0; i < size; i++) {
+        root = avl_insert(root, keys[i], &metrics);
+    }
+
+    std::printf("========================================\n");
+    std::printf("COROUTINE INTERLEAVED LOOKUP EXPERIMENT\n");
+    std::printf("========================================\n");
+    std::printf("Keys: %d, lookups: %d, height %d\n\n", size, lookups, avl_height(root));
+
+    long expected = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < lookups; i++) {
+        expected += avl_search(root, queries[i], &metrics) != nullptr;
+    }
+    double baseTime = nowSeconds() - start;
+
+    std::printf("avl_search: %.0f lookups/s, %ld found\n\n", lookups / baseTime, expected);
+    std::printf("%-8s %16s %16s\n", "Group", "batch lookups/s", "coro lookups/s");
+
+    for (int group : groups) {
+        start = nowSeconds();
+        avl_search_batch(root, queries.data(), lookups, results.data(), group, &metrics);
+        double batchTime = nowSeconds() - start;
+        long batchFound = countHits(results.data(), queries.data(), lookups);
+
+        start = nowSeconds();
+        searchInterleaved(root, queries.data(), lookups, results.data(), group, &metrics);
+        double coroTime = nowSeconds() - start;
+        long coroFound = countHits(results.data(), queries.data(), lookups);
+
+        std::printf("%-8d %16.0f %16.0f%s\n", group, lookups / batchTime, lookups / coroTime,
+                    batchFound == expected && coroFound == expected ? "" : " MISMATCH");
+    }
+    std::printf("\n");
+
+    freeAVL(root);
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <math.h>
 #include "dataset.h"
 
 void generateRandomData(int arr[], int n) { // gen random dataset
@@ -46,4 +47,113 @@ void shuffleArray(int arr[], int n) {
         arr[i] = arr[j];
         arr[j] = temp;
     }
-}
\ No newline at end of file
+}
+
+// uniform double in [0, 1), two rand() calls so small RAND_MAX still spreads
+static double randomUnit() {
+    double scale = (double)RAND_MAX + 1.0;
+    return (rand() * scale + rand()) / (scale * scale);
+}
+
+// zipf-distributed lookups over keys: the i-th hottest key is drawn with
+// probability proportional to 1 / i^skew, and hotness is a random permutation
+void generateZipfQueries(int queries[], int m, int keys[], int n, double skew) {
+    double* cdf = (double*)malloc(n * sizeof(double));
+    int* ranked = (int*)malloc(n * sizeof(int));
+    
+    if (cdf == NULL || ranked == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    for (int i = 0; i < n; i++) {
+        ranked[i] = keys[i];
+    }
+    shuffleArray(ranked, n);
+    
+    double total = 0.0;
+    for (int i = 0; i < n; i++) {
+        total += 1.0 / pow(i + 1, skew);
+        cdf[i] = total;
+    }
+    
+    for (int q = 0; q < m; q++) { // binary search the cdf
+        double u = randomUnit() * total;
+        int lo = 0;
+        int hi = n - 1;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (cdf[mid] < u) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        queries[q] = ranked[lo];
+    }
+    
+    free(cdf);
+    free(ranked);
+}
+
+unsigned int nextSeeded(unsigned int* state) { // xorshift32, never returns to 0 from a nonzero state
+    unsigned int x = *state ? *state : 2463534242u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// same shapes as the rand() generators above
+void generateSeededData(int arr[], int n, DatasetType type, unsigned int seed) {
+    unsigned int state = seed;
+    
+    switch (type) {
+    case DATASET_RANDOM:
+        for (int i = 0; i < n; i++) {
+            arr[i] = nextSeeded(&state) % 10000;
+        }
+        break;
+    case DATASET_SORTED:
+        generateSortedData(arr, n);
+        break;
+    case DATASET_REVERSE_SORTED:
+        generateReverseSortedData(arr, n);
+        break;
+    default:
+        generateSortedData(arr, n);
+        for (int i = 0; i < (int)(n * 0.1); i++) {
+            int idx1 = nextSeeded(&state) % n;
+            int idx2 = nextSeeded(&state) % n;
+            
+            int temp = arr[idx1];
+            arr[idx1] = arr[idx2];
+            arr[idx2] = temp;
+        }
+        break;
+    }
+}
+
+void shuffleSeeded(int arr[], int n, unsigned int seed) {
+    unsigned int state = seed ^ 0x9E3779B9u; // not the stream generateSeededData draws for the same seed
+    for (int i = n - 1; i > 0; i--) {
+        int j = nextSeeded(&state) % (i + 1);
+        int temp = arr[i];
+        arr[i] = arr[j];
+        arr[j] = temp;
+    }
+}
+
+const char* datasetTypeName(DatasetType type) {
+    switch (type) {
+    case DATASET_RANDOM:
+        return "RANDOM";
+    case DATASET_SORTED:
+        return "SORTED (ASCENDING)";
+    case DATASET_REVERSE_SORTED:
+        return "REVERSE SORTED (DESCENDING)";
+    default:
+        return "NEARLY SORTED (90%)";
+    }
+}
@@ -1,10 +1,33 @@
 #ifndef DATASET_H
 #define DATASET_H
 
+#ifdef __cplusplus // usable from the c++ coroutine front end
+extern "C" {
+#endif
+
+typedef enum { // dataset shapes used by the experiments
+    DATASET_RANDOM,
+    DATASET_SORTED,
+    DATASET_REVERSE_SORTED,
+    DATASET_NEARLY_SORTED, // 90% in place
+    DATASET_TYPES
+} DatasetType;
+
 void generateRandomData(int arr[], int n);
 void generateSortedData(int arr[], int n);
 void generateReverseSortedData(int arr[], int n);
 void generateNearlySortedData(int arr[], int n, float sorted_percentage);
 void shuffleArray(int arr[], int n);
+void generateZipfQueries(int queries[], int m, int keys[], int n, double skew);
+
+// reproducible and thread safe: all randomness comes from seed, not rand()
+unsigned int nextSeeded(unsigned int* state);
+void generateSeededData(int arr[], int n, DatasetType type, unsigned int seed);
+void shuffleSeeded(int arr[], int n, unsigned int seed);
+const char* datasetTypeName(DatasetType type);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
\ No newline at end of file
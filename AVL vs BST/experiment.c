@@ -1,11 +1,50 @@
+#define _POSIX_C_SOURCE 200112L // posix_fadvise, fdatasync
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "bst.h"
 #include "avl.h"
+#include "rbtree.h"
+#include "wavl.h"
+#include "splay.h"
+#include "treap.h"
+#include "scapegoat.h"
+#include "output.h"
+#include "memtrack.h"
+#include "avlfile.h"
+#include "avlimage.h"
+#include "wal.h"
+#include "orderedset.h"
+#include "matrix.h"
+#include "layout.h"
+#include "arena.h"
+#include "perfcount.h"
+#include "generic_tree.h"
+#include "avlmap.h"
+#include "multiset.h"
+#include "avllink.h"
 #include "dataset.h"
 
+DEFINE_GENERIC_BST(IntBSTNode, intbst, int, int, GENERIC_LESS, GENERIC_EQUAL)
+DEFINE_GENERIC_AVL(IntAVLNode, intavl, int, int, GENERIC_LESS, GENERIC_EQUAL)
+DEFINE_GENERIC_AVL(Int64AVLNode, avl64, long long, long long, GENERIC_LESS, GENERIC_EQUAL)
+DEFINE_GENERIC_AVL(StrAVLNode, stravl, const char*, int, GENERIC_STRING_LESS, GENERIC_STRING_EQUAL)
+
+// the same generic source stamped out with counters forced on and forced off,
+// so the overhead experiment can compare both in one binary
+#undef METRIC_ADD
+#define METRIC_ADD METRIC_ADD_ENABLED
+DEFINE_GENERIC_AVL(CountedAVLNode, countedavl, int, int, GENERIC_LESS, GENERIC_EQUAL)
+#undef METRIC_ADD
+#define METRIC_ADD METRIC_ADD_DISABLED
+DEFINE_GENERIC_AVL(BareAVLNode, bareavl, int, int, GENERIC_LESS, GENERIC_EQUAL)
+#undef METRIC_ADD
+#define METRIC_ADD METRIC_ADD_DEFAULT
+
 void printSeparator() {
     printf("========================================\n");
 }
@@ -16,109 +55,192 @@ void printHeader(char* title) {
     printSeparator();
 }
 
-void printMetricsComparison(char* datasetType, int size, 
-                           Metrics bstMetrics, AVLMetrics avlMetrics) {
+double nowSeconds() { // wall clock with sub-microsecond resolution
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void printMemoryRow(const char* name, MemStats* stats, int keys) {
+    printf("%-10s %10zu %10zu %9ld %8.2f %10zu %8ld\n", name, stats->live_bytes,
+           stats->peak_bytes, stats->allocations,
+           keys > 0 ? (double)stats->live_bytes / keys : 0.0,
+           memtrack_overhead(stats), stats->rss_growth_kb);
+}
+
+TreeMetrics* metricsFor(TreeMetrics metrics[], const char* name) { // the engine's row, NULL if not registered
+    const OrderedSetOps* ops = ordered_set_find(name);
+    for (int s = 0; ops != NULL && s < ordered_set_count(); s++) {
+        if (ordered_set_get(s) == ops) {
+            return &metrics[s];
+        }
+    }
+    return NULL;
+}
+
+// metrics and memory are indexed like the ordered set registry
+void printMetricsComparison(char* datasetType, int size, int uniqueKeys,
+                           TreeMetrics metrics[], MemStats memory[]) {
     printHeader("PERFORMANCE COMPARISON REPORT");
     printf("Dataset Type: %s\n", datasetType);
-    printf("Dataset Size: %d elements\n\n", size);
+    printf("Dataset Size: %d elements\n", size);
+    printf("Unique Keys:  %d (%d duplicates, dropped by the set trees)\n\n",
+           uniqueKeys, size - uniqueKeys);
     
-    printf("--- Binary Search Tree (BST) ---\n");
-    printf("Final Height:        %d\n", bstMetrics.final_height);
-    printf("Total Comparisons:   %ld\n", bstMetrics.comparisons);
-    printf("Insertion Time:      %.6f seconds\n\n", bstMetrics.time_taken);
+    for (int s = 0; s < ordered_set_count(); s++) {
+        const OrderedSetOps* ops = ordered_set_get(s);
+        printf("--- %s ---\n", ops->description);
+        printf("Final Height:        %d\n", metrics[s].final_height);
+        printf("Total Comparisons:   %ld\n", metrics[s].comparisons);
+        if (ops->rotates) {
+            printf("Total Rotations:     %ld\n", metrics[s].rotations);
+        }
+        if (metrics[s].rebuilds > 0) {
+            printf("Subtree Rebuilds:    %ld (%ld nodes)\n", metrics[s].rebuilds, metrics[s].rebuilt_nodes);
+        }
+        printf("Insertion Time:      %.6f seconds\n\n", metrics[s].time_taken);
+    }
     
-    printf("--- AVL Tree (Balanced) ---\n");
-    printf("Final Height:        %d\n", avlMetrics.final_height);
-    printf("Total Comparisons:   %ld\n", avlMetrics.comparisons);
-    printf("Total Rotations:     %ld\n", avlMetrics.rotations);
-    printf("Insertion Time:      %.6f seconds\n\n", avlMetrics.time_taken);
+    printf("--- Memory Footprint (bytes, allocator accounting) ---\n");
+    printf("%-10s %10s %10s %9s %8s %10s %8s\n", "Structure", "Live", "Peak",
+           "Allocs", "Per Key", "Overhead", "RSS kB");
+    for (int s = 0; s < ordered_set_count(); s++) {
+        printMemoryRow(ordered_set_get(s)->name, &memory[s], uniqueKeys);
+    }
     
-    printf("--- Analysis ---\n");
-
-    if (bstMetrics.final_height > avlMetrics.final_height) { // height compare
-        double heightRatio = (double)bstMetrics.final_height / avlMetrics.final_height;
-        printf("BST is %.2fx taller than AVL\n", heightRatio);
+    long rssKb, peakKb;
+    if (memtrack_read_rss(&rssKb, &peakKb)) {
+        printf("Process RSS: %ld kB, peak %ld kB\n\n", rssKb, peakKb);
+    } else {
+        printf("Process RSS: n/a\n\n");
     }
     
-    // comparison of time (with zero-check)
-    if (bstMetrics.time_taken > 0.000001 && avlMetrics.time_taken > 0.000001) {
-        if (bstMetrics.time_taken > avlMetrics.time_taken) {
-            double speedup = bstMetrics.time_taken / avlMetrics.time_taken;
-            printf("AVL is %.2fx faster for insertions\n", speedup);
+    printf("--- Analysis ---\n");
+    TreeMetrics* bst = metricsFor(metrics, "BST");
+    TreeMetrics* avl = metricsFor(metrics, "AVL");
+    TreeMetrics* rb = metricsFor(metrics, "Red-Black");
+    
+    if (bst != NULL && avl != NULL) {
+        TreeMetrics bstMetrics = *bst;
+        TreeMetrics avlMetrics = *avl;
+        
+        if (bstMetrics.final_height > avlMetrics.final_height) { // height compare
+            double heightRatio = (double)bstMetrics.final_height / avlMetrics.final_height;
+            printf("BST is %.2fx taller than AVL\n", heightRatio);
+        }
+        
+        // comparison of time (with zero-check)
+        if (bstMetrics.time_taken > 0.000001 && avlMetrics.time_taken > 0.000001) {
+            if (bstMetrics.time_taken > avlMetrics.time_taken) {
+                double speedup = bstMetrics.time_taken / avlMetrics.time_taken;
+                printf("AVL is %.2fx faster for insertions\n", speedup);
+            } else {
+                double speedup = avlMetrics.time_taken / bstMetrics.time_taken;
+                printf("BST is %.2fx faster for insertions\n", speedup);
+            }
         } else {
-            double speedup = avlMetrics.time_taken / bstMetrics.time_taken;
-            printf("BST is %.2fx faster for insertions\n", speedup);
+            printf("Insertion times too small to measure accurately\n");
+        }
+        
+        if (bstMetrics.comparisons > avlMetrics.comparisons) {
+            double compRatio = (double)bstMetrics.comparisons / avlMetrics.comparisons;
+            printf("BST made %.2fx more comparisons\n", compRatio);
         }
-    } else {
-        printf("Insertion times too small to measure accurately\n");
     }
     
-    if (bstMetrics.comparisons > avlMetrics.comparisons) {
-        double compRatio = (double)bstMetrics.comparisons / avlMetrics.comparisons;
-        printf("BST made %.2fx more comparisons\n", compRatio);
+    // rotation cost of the two balanced trees
+    if (avl != NULL && rb != NULL && avl->rotations > 0 && rb->rotations > 0) {
+        if (avl->rotations > rb->rotations) {
+            double rotRatio = (double)avl->rotations / rb->rotations;
+            printf("AVL made %.2fx more rotations than Red-Black\n", rotRatio);
+        } else {
+            double rotRatio = (double)rb->rotations / avl->rotations;
+            printf("Red-Black made %.2fx more rotations than AVL\n", rotRatio);
+        }
     }
     
     printf("\n");
 }
 
-void runExperiment(int dataset[], int size, char* datasetType) {
-    Metrics bstMetrics = {0, 0.0, 0};
-    AVLMetrics avlMetrics = {0, 0, 0.0, 0};
+int compareInts(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
 
-    printf("Testing BST with %s data...\n", datasetType);
-    BSTNode* bstRoot = NULL;
-    clock_t start = clock();
+int countUniqueKeys(int dataset[], int size) {
+    int* sorted = (int*)malloc(size * sizeof(int));
     
-    for (int i = 0; i < size; i++) {
-        bstRoot = bst_insert(bstRoot, dataset[i], &bstMetrics);
+    if (sorted == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
     }
     
-    clock_t end = clock();
-    bstMetrics.time_taken = (double)(end - start) / CLOCKS_PER_SEC;
-    bstMetrics.final_height = bst_height(bstRoot);
+    memcpy(sorted, dataset, size * sizeof(int));
+    qsort(sorted, size, sizeof(int), compareInts);
     
-    printf("Testing AVL with %s data...\n", datasetType);
-    AVLNode* avlRoot = NULL;
-    start = clock();
-    
-    for (int i = 0; i < size; i++) {
-        avlRoot = avl_insert(avlRoot, dataset[i], &avlMetrics);
+    int unique = size > 0 ? 1 : 0;
+    for (int i = 1; i < size; i++) {
+        unique += sorted[i] != sorted[i - 1];
     }
+    free(sorted);
+    return unique;
+}
+
+// every phase runs over all registered ordered sets
+void runExperiment(int dataset[], int size, char* datasetType) {
+    int count = ordered_set_count();
+    void* sets[ORDERED_SET_MAX];
+    TreeMetrics metrics[ORDERED_SET_MAX];
+    MemStats memory[ORDERED_SET_MAX];
     
-    end = clock();
-    avlMetrics.time_taken = (double)(end - start) / CLOCKS_PER_SEC;
-    avlMetrics.final_height = avl_height(avlRoot);
+    for (int s = 0; s < count; s++) {
+        const OrderedSetOps* ops = ordered_set_get(s);
+        TreeMetrics empty = {0};
+        metrics[s] = empty;
+        
+        printf("Testing %s with %s data...\n", ops->name, datasetType);
+        memtrack_begin(&memory[s]);
+        clock_t start = clock();
+        sets[s] = ops->create();
+        
+        for (int i = 0; i < size; i++) {
+            ops->insert(sets[s], dataset[i], &metrics[s]);
+        }
+        
+        clock_t end = clock();
+        memtrack_end(&memory[s]);
+        metrics[s].time_taken = (double)(end - start) / CLOCKS_PER_SEC;
+        metrics[s].final_height = ops->height(sets[s]);
+    }
     
     // print the comparison
-    printMetricsComparison(datasetType, size, bstMetrics, avlMetrics);
+    printMetricsComparison(datasetType, size, countUniqueKeys(dataset, size), metrics, memory);
     
     // search test
     printf("--- Search Performance Test ---\n");
     int searchKey = dataset[size / 2]; 
+    printf("Searching for key: %d\n", searchKey);
     
-    Metrics bstSearchMetrics = {0, 0.0, 0};
-    AVLMetrics avlSearchMetrics = {0, 0, 0.0, 0};
-    
-    start = clock();
-    BSTNode* bstResult = bst_search(bstRoot, searchKey, &bstSearchMetrics);
-    end = clock();
-    double bstSearchTime = (double)(end - start) / CLOCKS_PER_SEC;
-    
-    start = clock();
-    AVLNode* avlResult = avl_search(avlRoot, searchKey, &avlSearchMetrics);
-    end = clock();
-    double avlSearchTime = (double)(end - start) / CLOCKS_PER_SEC;
+    TreeMetrics searchMetrics[ORDERED_SET_MAX];
+    for (int s = 0; s < count; s++) {
+        const OrderedSetOps* ops = ordered_set_get(s);
+        TreeMetrics empty = {0};
+        searchMetrics[s] = empty;
+        
+        clock_t start = clock();
+        int found = ops->contains(sets[s], searchKey, &searchMetrics[s]);
+        clock_t end = clock();
+        
+        printf("%-10s %ld comparisons, %.6f seconds, %s\n", ops->name,
+               searchMetrics[s].comparisons, (double)(end - start) / CLOCKS_PER_SEC,
+               found ? "FOUND" : "NOT FOUND");
+    }
     
-    printf("Searching for key: %d\n", searchKey);
-    printf("BST: %ld comparisons, %.6f seconds, %s\n", 
-           bstSearchMetrics.comparisons, bstSearchTime,
-           bstResult ? "FOUND" : "NOT FOUND");
-    printf("AVL: %ld comparisons, %.6f seconds, %s\n", 
-           avlSearchMetrics.comparisons, avlSearchTime,
-           avlResult ? "FOUND" : "NOT FOUND");
-    
-    if (bstSearchMetrics.comparisons > avlSearchMetrics.comparisons) {
-        double ratio = (double)bstSearchMetrics.comparisons / avlSearchMetrics.comparisons;
+    TreeMetrics* bst = metricsFor(searchMetrics, "BST");
+    TreeMetrics* avl = metricsFor(searchMetrics, "AVL");
+    if (bst != NULL && avl != NULL && bst->comparisons > avl->comparisons) {
+        double ratio = (double)bst->comparisons / avl->comparisons;
         printf("BST required %.2fx more comparisons for search\n", ratio);
     }
     
@@ -126,21 +248,1952 @@ void runExperiment(int dataset[], int size, char* datasetType) {
     printSeparator();
     printf("\n");
     
-    freeBST(bstRoot); // free memories
+    for (int s = 0; s < count; s++) { // free memories
+        ordered_set_get(s)->destroy(sets[s]);
+    }
+}
+
+// delete-heavy churn: AVL vs WAVL rebalancing cost per delete
+void runChurnExperiment(int size, int rounds) {
+    int poolSize = 2 * size; // first half present in the trees, second half absent
+    int batch = size / 10;
+    int* pool = (int*)malloc(poolSize * sizeof(int));
+    
+    if (pool == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(pool, poolSize);
+    shuffleArray(pool, poolSize);
+    
+    AVLMetrics avlBuild = {0};
+    WAVLMetrics wavlBuild = {0, 0, 0.0, 0};
+    AVLNode* avlRoot = NULL;
+    WAVLNode* wavlRoot = NULL;
+    
+    for (int i = 0; i < size; i++) {
+        avlRoot = avl_insert(avlRoot, pool[i], &avlBuild);
+        wavlRoot = wavl_insert(wavlRoot, pool[i], &wavlBuild);
+    }
+    
+    printHeader("CHURN EXPERIMENT: AVL vs WAVL DELETE");
+    printf("Live keys: %d, rounds: %d, deletes+inserts per round: %d\n\n", size, rounds, batch);
+    printf("After insert-only build:\n");
+    printf("AVL  height %d, rotations %ld\n", avl_height(avlRoot), avlBuild.rotations);
+    printf("WAVL height %d, rotations %ld\n\n", wavl_height(wavlRoot), wavlBuild.rotations);
+    
+    AVLMetrics avlDelete = {0};
+    WAVLMetrics wavlDelete = {0, 0, 0.0, 0};
+    AVLMetrics avlInsert = {0};
+    WAVLMetrics wavlInsert = {0, 0, 0.0, 0};
+    
+    for (int r = 0; r < rounds; r++) {
+        for (int i = 0; i < batch; i++) { // move a random live key to the front
+            int j = i + rand() % (size - i);
+            int temp = pool[i];
+            pool[i] = pool[j];
+            pool[j] = temp;
+        }
+        
+        double start = nowSeconds();
+        for (int i = 0; i < batch; i++) {
+            avlRoot = avl_delete(avlRoot, pool[i], &avlDelete);
+        }
+        avlDelete.time_taken += nowSeconds() - start;
+        
+        start = nowSeconds();
+        for (int i = 0; i < batch; i++) {
+            wavlRoot = wavl_delete(wavlRoot, pool[i], &wavlDelete);
+        }
+        wavlDelete.time_taken += nowSeconds() - start;
+        
+        for (int i = 0; i < batch; i++) { // refill from the absent half
+            int fresh = pool[size + i];
+            avlRoot = avl_insert(avlRoot, fresh, &avlInsert);
+            wavlRoot = wavl_insert(wavlRoot, fresh, &wavlInsert);
+            pool[size + i] = pool[i];
+            pool[i] = fresh;
+        }
+    }
+    
+    long deletes = (long)rounds * batch;
+    
+    printf("--- Delete Phase (%ld deletes) ---\n", deletes);
+    printf("AVL  rotations/delete: %.4f, %.1f ns/delete\n",
+           (double)avlDelete.rotations / deletes, avlDelete.time_taken * 1e9 / deletes);
+    printf("WAVL rotations/delete: %.4f, %.1f ns/delete\n",
+           (double)wavlDelete.rotations / deletes, wavlDelete.time_taken * 1e9 / deletes);
+    printf("\n--- Insert Phase ---\n");
+    printf("AVL  rotations/insert: %.4f\n", (double)avlInsert.rotations / deletes);
+    printf("WAVL rotations/insert: %.4f\n", (double)wavlInsert.rotations / deletes);
+    printf("\nFinal heights: AVL %d, WAVL %d\n\n",
+           avl_height(avlRoot), wavl_height(wavlRoot));
+    
     freeAVL(avlRoot);
+    freeWAVL(wavlRoot);
+    free(pool);
 }
 
-int main() {
-    srand(time(NULL));
+// zipf-skewed lookups: self-adjusting splay and randomized treap vs AVL
+void runSkewedExperiment(int size, int queryCount) {
+    double skews[] = {0.0, 0.8, 0.99, 1.2};
+    int numSkews = 4;
+    int* keys = (int*)malloc(size * sizeof(int));
+    int* queries = (int*)malloc(queryCount * sizeof(int));
     
-    int sizes[] = {100, 1000, 5000};
-    int numSizes = 3;
+    if (keys == NULL || queries == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
     
-    printf("\n");
-    printHeader("AVL vs BST PERFORMANCE EXPERIMENT");
-    printf("This experiment compares the performance of\n");
-    printf("balanced (AVL) and unbalanced (BST) trees\n");
-    printf("across different dataset scenarios.\n\n");
+    generateSortedData(keys, size);
+    shuffleArray(keys, size);
+    
+    AVLMetrics avlBuild = {0};
+    TreapMetrics treapBuild = {0, 0, 0.0, 0};
+    AVLNode* avlRoot = NULL;
+    TreapNode* treapRoot = NULL;
+    
+    for (int i = 0; i < size; i++) {
+        avlRoot = avl_insert(avlRoot, keys[i], &avlBuild);
+        treapRoot = treap_insert(treapRoot, keys[i], &treapBuild);
+    }
+    
+    printHeader("SKEWED LOOKUP EXPERIMENT: AVL vs SPLAY vs TREAP");
+    printf("Keys: %d, lookups per skew: %d\n", size, queryCount);
+    printf("Heights: AVL %d, Treap %d\n\n", avl_height(avlRoot), treap_height(treapRoot));
+    
+    for (int k = 0; k < numSkews; k++) {
+        generateZipfQueries(queries, queryCount, keys, size, skews[k]);
+        
+        SplayMetrics splayBuild = {0, 0, 0.0, 0}; // fresh splay tree, no state from the previous skew
+        SplayNode* splayRoot = NULL;
+        for (int i = 0; i < size; i++) {
+            splayRoot = splay_insert(splayRoot, keys[i], &splayBuild);
+        }
+        
+        AVLMetrics avlMetrics = {0};
+        SplayMetrics splayMetrics = {0, 0, 0.0, 0};
+        TreapMetrics treapMetrics = {0, 0, 0.0, 0};
+        long found = 0;
+        
+        double start = nowSeconds();
+        for (int q = 0; q < queryCount; q++) {
+            found += avl_search(avlRoot, queries[q], &avlMetrics) != NULL;
+        }
+        avlMetrics.time_taken = nowSeconds() - start;
+        
+        start = nowSeconds();
+        for (int q = 0; q < queryCount; q++) {
+            splayRoot = splay_search(splayRoot, queries[q], &splayMetrics);
+            found += splayRoot->data == queries[q];
+        }
+        splayMetrics.time_taken = nowSeconds() - start;
+        
+        start = nowSeconds();
+        for (int q = 0; q < queryCount; q++) {
+            found += treap_search(treapRoot, queries[q], &treapMetrics) != NULL;
+        }
+        treapMetrics.time_taken = nowSeconds() - start;
+        
+        printf("--- Zipf skew %.2f ---\n", skews[k]);
+        printf("AVL:   %.2f comparisons/lookup, %.1f ns/lookup\n",
+               (double)avlMetrics.comparisons / queryCount, avlMetrics.time_taken * 1e9 / queryCount);
+        printf("Splay: %.2f comparisons/lookup, %.1f ns/lookup, %.2f rotations/lookup\n",
+               (double)splayMetrics.comparisons / queryCount, splayMetrics.time_taken * 1e9 / queryCount,
+               (double)splayMetrics.rotations / queryCount);
+        printf("Treap: %.2f comparisons/lookup, %.1f ns/lookup\n",
+               (double)treapMetrics.comparisons / queryCount, treapMetrics.time_taken * 1e9 / queryCount);
+        printf("Found %ld of %ld lookups\n\n", found, 3L * queryCount);
+        
+        freeSplay(splayRoot);
+    }
+    
+    freeAVL(avlRoot);
+    freeTreap(treapRoot);
+    free(keys);
+    free(queries);
+}
+
+// full in-order walk, what range queries cost without pruning or subtree sizes
+void linearCountRange(AVLNode* root, int lo, int hi, int* count) {
+    if (root != NULL) {
+        linearCountRange(root->left, lo, hi, count);
+        if (root->data >= lo && root->data <= hi) {
+            (*count)++;
+        }
+        linearCountRange(root->right, lo, hi, count);
+    }
+}
+
+void sumVisitor(AVLNode* node, void* context) {
+    *(long*)context += node->data;
+}
+
+void bstSumVisitor(BSTNode* node, void* context) {
+    *(long*)context += node->data;
+}
+
+// range scans of growing selectivity: cursor, pruned visit (AVL and BST), full walk
+void runRangeScanExperiment(int size, int scanCount) {
+    double selectivities[] = {0.0001, 0.001, 0.01, 0.1};
+    int numSelectivities = 4;
+    int* keys = (int*)malloc(size * sizeof(int));
+    
+    if (keys == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(keys, size);
+    shuffleArray(keys, size);
+    
+    AVLMetrics buildMetrics = {0};
+    Metrics bstMetrics = {0, 0.0, 0};
+    AVLNode* root = NULL;
+    BSTNode* bstRoot = NULL;
+    for (int i = 0; i < size; i++) {
+        root = avl_insert(root, keys[i], &buildMetrics);
+        bstRoot = bst_insert(bstRoot, keys[i], &bstMetrics);
+    }
+    
+    printHeader("RANGE SCAN EXPERIMENT");
+    printf("Keys: %d (random insertion order), scans per selectivity: %d\n", size, scanCount);
+    printf("Heights: AVL %d, BST %d\n\n", avl_height(root), bst_height(bstRoot));
+    
+    for (int k = 0; k < numSelectivities; k++) {
+        int width = (int)(size * selectivities[k]);
+        long cursorSum = 0;
+        long visitSum = 0;
+        long bstVisitSum = 0;
+        long walkCount = 0;
+        long keysScanned = 0;
+        
+        double start = nowSeconds();
+        for (int q = 0; q < scanCount; q++) {
+            int lo = keys[q % size];
+            AVLCursor cursor;
+            for (avl_cursor_seek(&cursor, root, lo); avl_cursor_valid(&cursor); avl_cursor_next(&cursor)) {
+                AVLNode* node = avl_cursor_node(&cursor);
+                if (node->data > lo + width) {
+                    break;
+                }
+                cursorSum += node->data;
+                keysScanned++;
+            }
+        }
+        double cursorTime = nowSeconds() - start;
+        
+        start = nowSeconds();
+        for (int q = 0; q < scanCount; q++) {
+            int lo = keys[q % size];
+            avl_range_visit(root, lo, lo + width, sumVisitor, &visitSum);
+        }
+        double visitTime = nowSeconds() - start;
+        
+        start = nowSeconds();
+        for (int q = 0; q < scanCount; q++) {
+            int lo = keys[q % size];
+            bst_range_visit(bstRoot, lo, lo + width, bstSumVisitor, &bstVisitSum);
+        }
+        double bstVisitTime = nowSeconds() - start;
+        
+        start = nowSeconds();
+        for (int q = 0; q < scanCount; q++) {
+            int lo = keys[q % size];
+            int count = 0;
+            linearCountRange(root, lo, lo + width, &count);
+            walkCount += count;
+        }
+        double walkTime = nowSeconds() - start;
+        
+        printf("--- Selectivity %.2f%% (%.1f keys/scan) ---\n",
+               selectivities[k] * 100, (double)keysScanned / scanCount);
+        printf("Cursor:      %.1f ns/scan, %.1f M keys/sec\n",
+               cursorTime * 1e9 / scanCount, keysScanned / cursorTime / 1e6);
+        printf("Range visit: %.1f ns/scan, %.1f M keys/sec\n",
+               visitTime * 1e9 / scanCount, keysScanned / visitTime / 1e6);
+        printf("BST visit:   %.1f ns/scan, %.1f M keys/sec\n",
+               bstVisitTime * 1e9 / scanCount, keysScanned / bstVisitTime / 1e6);
+        printf("Full walk:   %.1f ns/scan\n", walkTime * 1e9 / scanCount);
+        printf("%s\n\n", (cursorSum == visitSum && bstVisitSum == visitSum && walkCount == keysScanned)
+               ? "Results match" : "RESULTS DIFFER");
+    }
+    
+    freeAVL(root);
+    freeBST(bstRoot);
+    free(keys);
+}
+
+typedef struct { // stdout temporarily pointed at a temporary file
+    FILE* file;
+    int savedStdout;
+} StdoutCapture;
+
+void captureBegin(StdoutCapture* capture) {
+    fflush(stdout);
+    capture->file = tmpfile();
+    if (capture->file == NULL) {
+        perror("tmpfile");
+        exit(1);
+    }
+    capture->savedStdout = dup(STDOUT_FILENO);
+    dup2(fileno(capture->file), STDOUT_FILENO);
+}
+
+int captureMatches(StdoutCapture* capture, const char* expected, size_t length) { // ends the capture
+    fflush(stdout);
+    dup2(capture->savedStdout, STDOUT_FILENO);
+    close(capture->savedStdout);
+    
+    int match = fseek(capture->file, 0, SEEK_END) == 0 && (size_t)ftell(capture->file) == length;
+    rewind(capture->file);
+    char chunk[4096];
+    size_t offset = 0;
+    while (match && offset < length) {
+        size_t n = fread(chunk, 1, sizeof(chunk), capture->file);
+        match = n > 0 && memcmp(chunk, expected + offset, n) == 0;
+        offset += n;
+    }
+    fclose(capture->file);
+    return match;
+}
+
+// dumping every key: per-key printf vs caller buffer vs buffered write(2)
+void runDumpExperiment(int size) {
+    int* keys = (int*)malloc(size * sizeof(int));
+    size_t capacity = (size_t)size * OUTPUT_INT_MAX_CHARS + 1; // room for the terminator
+    char* buffer = (char*)malloc(capacity);
+    
+    if (keys == NULL || buffer == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(keys, size);
+    shuffleArray(keys, size);
+    
+    AVLMetrics avlMetrics = {0};
+    Metrics bstMetrics = {0, 0.0, 0};
+    AVLNode* avlRoot = NULL;
+    BSTNode* bstRoot = NULL;
+    for (int i = 0; i < size; i++) {
+        avlRoot = avl_insert(avlRoot, keys[i], &avlMetrics);
+        bstRoot = bst_insert(bstRoot, keys[i], &bstMetrics);
+    }
+    
+    int nullFd = open("/dev/null", O_WRONLY);
+    if (nullFd < 0) {
+        perror("open /dev/null");
+        exit(1);
+    }
+    
+    printHeader("TREE DUMP EXPERIMENT");
+    printf("Keys: %d (output discarded to /dev/null)\n\n", size);
+    fflush(stdout);
+    
+    int savedStdout = dup(STDOUT_FILENO); // point stdout at /dev/null for the printf versions
+    dup2(nullFd, STDOUT_FILENO);
+    
+    double start = nowSeconds();
+    avl_inorder(avlRoot);
+    fflush(stdout);
+    double avlPrintfTime = nowSeconds() - start;
+    
+    start = nowSeconds();
+    bst_inorder(bstRoot);
+    fflush(stdout);
+    double bstPrintfTime = nowSeconds() - start;
+    
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    
+    start = nowSeconds();
+    size_t avlBytes = avl_inorder_buffer(avlRoot, buffer, capacity);
+    double avlBufferTime = nowSeconds() - start;
+    
+    start = nowSeconds();
+    size_t bstBytes = bst_inorder_buffer(bstRoot, buffer, capacity);
+    double bstBufferTime = nowSeconds() - start;
+    
+    start = nowSeconds();
+    avl_inorder_fd(avlRoot, nullFd);
+    double avlFdTime = nowSeconds() - start;
+    
+    start = nowSeconds();
+    bst_inorder_fd(bstRoot, nullFd);
+    double bstFdTime = nowSeconds() - start;
+    
+    int identical = avlBytes < capacity && bstBytes < capacity; // printf and write(2) text vs the buffer
+    StdoutCapture capture;
+    avl_inorder_buffer(avlRoot, buffer, capacity);
+    identical = identical && strlen(buffer) == avlBytes;
+    captureBegin(&capture);
+    avl_inorder(avlRoot);
+    identical = captureMatches(&capture, buffer, avlBytes) && identical;
+    captureBegin(&capture);
+    avl_inorder_fd(avlRoot, STDOUT_FILENO);
+    identical = captureMatches(&capture, buffer, avlBytes) && identical;
+    
+    bst_inorder_buffer(bstRoot, buffer, capacity);
+    identical = identical && strlen(buffer) == bstBytes;
+    captureBegin(&capture);
+    bst_inorder(bstRoot);
+    identical = captureMatches(&capture, buffer, bstBytes) && identical;
+    captureBegin(&capture);
+    bst_inorder_fd(bstRoot, STDOUT_FILENO);
+    identical = captureMatches(&capture, buffer, bstBytes) && identical;
+    
+    double megabytes = avlBytes / 1e6;
+    printf("--- AVL (%zu bytes) ---\n", avlBytes);
+    printf("printf per key:   %.4f seconds, %.1f MB/s\n", avlPrintfTime, megabytes / avlPrintfTime);
+    printf("Caller buffer:    %.4f seconds, %.1f MB/s\n", avlBufferTime, megabytes / avlBufferTime);
+    printf("Buffered write:   %.4f seconds, %.1f MB/s\n\n", avlFdTime, megabytes / avlFdTime);
+    
+    megabytes = bstBytes / 1e6;
+    printf("--- BST (%zu bytes) ---\n", bstBytes);
+    printf("printf per key:   %.4f seconds, %.1f MB/s\n", bstPrintfTime, megabytes / bstPrintfTime);
+    printf("Caller buffer:    %.4f seconds, %.1f MB/s\n", bstBufferTime, megabytes / bstBufferTime);
+    printf("Buffered write:   %.4f seconds, %.1f MB/s\n\n", bstFdTime, megabytes / bstFdTime);
+    printf("printf, buffer and write(2) text identical: %s\n\n", identical ? "PASS" : "FAIL");
+    
+    close(nullFd);
+    freeAVL(avlRoot);
+    freeBST(bstRoot);
+    free(buffer);
+    free(keys);
+}
+
+void printTiming(char* label, double insertTime, double searchTime, int size) {
+    printf("%-22s insert %7.1f ns/key, search %7.1f ns/key\n",
+           label, insertTime * 1e9 / size, searchTime * 1e9 / size);
+}
+
+// macro-instantiated trees vs the hand-written int versions
+void runGenericExperiment(int size) {
+    int* keys = (int*)malloc(size * sizeof(int));
+    int* queries = (int*)malloc(size * sizeof(int));
+    char (*names)[OUTPUT_INT_MAX_CHARS] = malloc(size * sizeof(*names));
+    
+    if (keys == NULL || queries == NULL || names == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(keys, size);
+    shuffleArray(keys, size);
+    for (int i = 0; i < size; i++) { // lookups in a different order than the inserts
+        queries[i] = keys[i];
+    }
+    shuffleArray(queries, size);
+    
+    printHeader("GENERIC TREE PARITY EXPERIMENT");
+    printf("Keys: %d (random order)\n\n", size);
+    
+    AVLMetrics avlMetrics = {0};
+    AVLNode* avlRoot = NULL;
+    long found = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        avlRoot = avl_insert(avlRoot, keys[i], &avlMetrics);
+    }
+    double insertTime = nowSeconds() - start;
+    start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        found += avl_search(avlRoot, queries[i], &avlMetrics) != NULL;
+    }
+    printTiming("avl (hand-written)", insertTime, nowSeconds() - start, size);
+    long avlRotations = avlMetrics.rotations;
+    freeAVL(avlRoot);
+    
+    AVLMetrics genericMetrics = {0};
+    IntAVLNode* intRoot = NULL;
+    start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        intRoot = intavl_insert(intRoot, keys[i], i, &genericMetrics);
+    }
+    insertTime = nowSeconds() - start;
+    start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        found += intavl_search(intRoot, queries[i], &genericMetrics) != NULL;
+    }
+    printTiming("avl<int, int>", insertTime, nowSeconds() - start, size);
+    long genericRotations = genericMetrics.rotations;
+    intavl_free(intRoot);
+    
+    Metrics bstMetrics = {0, 0.0, 0};
+    BSTNode* bstRoot = NULL;
+    start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        bstRoot = bst_insert(bstRoot, keys[i], &bstMetrics);
+    }
+    insertTime = nowSeconds() - start;
+    start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        found += bst_search(bstRoot, queries[i], &bstMetrics) != NULL;
+    }
+    printTiming("bst (hand-written)", insertTime, nowSeconds() - start, size);
+    freeBST(bstRoot);
+    
+    Metrics genericBstMetrics = {0, 0.0, 0};
+    IntBSTNode* intBstRoot = NULL;
+    start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        intBstRoot = intbst_insert(intBstRoot, keys[i], i, &genericBstMetrics);
+    }
+    insertTime = nowSeconds() - start;
+    start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        found += intbst_search(intBstRoot, queries[i], &genericBstMetrics) != NULL;
+    }
+    printTiming("bst<int, int>", insertTime, nowSeconds() - start, size);
+    intbst_free(intBstRoot);
+    
+    AVLMetrics wideMetrics = {0};
+    Int64AVLNode* wideRoot = NULL;
+    start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        wideRoot = avl64_insert(wideRoot, (long long)keys[i] << 32, keys[i], &wideMetrics);
+    }
+    insertTime = nowSeconds() - start;
+    start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        found += avl64_search(wideRoot, (long long)queries[i] << 32, &wideMetrics) != NULL;
+    }
+    printTiming("avl<int64, int64>", insertTime, nowSeconds() - start, size);
+    avl64_free(wideRoot);
+    
+    for (int i = 0; i < size; i++) {
+        names[i][formatInt(names[i], keys[i])] = '\0';
+    }
+    AVLMetrics stringMetrics = {0};
+    StrAVLNode* stringRoot = NULL;
+    start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        stringRoot = stravl_insert(stringRoot, names[i], keys[i], &stringMetrics);
+    }
+    insertTime = nowSeconds() - start;
+    start = nowSeconds();
+    for (int i = 0; i < size; i++) {
+        found += stravl_search(stringRoot, names[i], &stringMetrics) != NULL;
+    }
+    printTiming("avl<string, int>", insertTime, nowSeconds() - start, size);
+    stravl_free(stringRoot);
+    
+    printf("\nRotations: hand-written %ld, generic %ld (%s)\n", avlRotations, genericRotations,
+           avlRotations == genericRotations ? "identical shape" : "SHAPES DIFFER");
+    printf("Found %ld of %ld lookups\n\n", found, 6L * size);
+    
+    free(names);
+    free(queries);
+    free(keys);
+}
+
+// update-heavy map workload: in-place upsert vs delete + insert
+void runMapExperiment(int size, int updateCount) {
+    int* keys = (int*)malloc(size * sizeof(int));
+    int* updates = (int*)malloc(updateCount * sizeof(int));
+    long* records = (long*)calloc(size + 1, sizeof(long)); // handle targets, indexed by key
+    
+    if (keys == NULL || updates == NULL || records == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(keys, size);
+    shuffleArray(keys, size);
+    for (int i = 0; i < updateCount; i++) {
+        updates[i] = keys[rand() % size];
+    }
+    
+    MapValue zero;
+    memset(&zero, 0, sizeof(zero));
+    AVLMetrics buildMetrics = {0};
+    AVLMapNode* upsertRoot = NULL;
+    AVLMapNode* slotRoot = NULL;
+    AVLMapNode* reinsertRoot = NULL;
+    AVLHandleMapNode* handleRoot = NULL;
+    for (int i = 0; i < size; i++) {
+        upsertRoot = avlmap_insert(upsertRoot, keys[i], zero, &buildMetrics);
+        slotRoot = avlmap_insert(slotRoot, keys[i], zero, &buildMetrics);
+        reinsertRoot = avlmap_insert(reinsertRoot, keys[i], zero, &buildMetrics);
+        handleRoot = handlemap_insert(handleRoot, keys[i], &records[keys[i]], &buildMetrics);
+    }
+    
+    printHeader("KEY-VALUE MAP UPDATE EXPERIMENT");
+    printf("Keys: %d, updates: %d, inline value size: %d bytes\n\n",
+           size, updateCount, AVL_MAP_VALUE_SIZE);
+    
+    AVLMetrics upsertMetrics = {0};
+    double start = nowSeconds();
+    for (int i = 0; i < updateCount; i++) {
+        MapValue value = zero;
+        memcpy(value.bytes, &i, sizeof(i));
+        upsertRoot = avlmap_upsert(upsertRoot, updates[i], value, &upsertMetrics);
+    }
+    upsertMetrics.time_taken = nowSeconds() - start;
+    
+    AVLMetrics slotMetrics = {0};
+    start = nowSeconds();
+    for (int i = 0; i < updateCount; i++) { // read-modify-write through the slot
+        MapValue* slot;
+        int counter;
+        slotRoot = avlmap_get_or_insert(slotRoot, updates[i], zero, &slot, &slotMetrics);
+        memcpy(&counter, slot->bytes, sizeof(counter));
+        counter++;
+        memcpy(slot->bytes, &counter, sizeof(counter));
+    }
+    slotMetrics.time_taken = nowSeconds() - start;
+    
+    AVLMetrics reinsertMetrics = {0};
+    start = nowSeconds();
+    for (int i = 0; i < updateCount; i++) {
+        MapValue value = zero;
+        memcpy(value.bytes, &i, sizeof(i));
+        reinsertRoot = avlmap_delete(reinsertRoot, updates[i], &reinsertMetrics);
+        reinsertRoot = avlmap_insert(reinsertRoot, updates[i], value, &reinsertMetrics);
+    }
+    reinsertMetrics.time_taken = nowSeconds() - start;
+    
+    AVLMetrics handleMetrics = {0};
+    start = nowSeconds();
+    for (int i = 0; i < updateCount; i++) {
+        void** slot;
+        handleRoot = handlemap_get_or_insert(handleRoot, updates[i], NULL, &slot, &handleMetrics);
+        (*(long*)*slot)++;
+    }
+    handleMetrics.time_taken = nowSeconds() - start;
+    
+    printf("Upsert (inline):        %7.1f ns/update, %.2f rotations/update\n",
+           upsertMetrics.time_taken * 1e9 / updateCount, (double)upsertMetrics.rotations / updateCount);
+    printf("Get-or-insert (inline): %7.1f ns/update, %.2f rotations/update\n",
+           slotMetrics.time_taken * 1e9 / updateCount, (double)slotMetrics.rotations / updateCount);
+    printf("Get-or-insert (handle): %7.1f ns/update, %.2f rotations/update\n",
+           handleMetrics.time_taken * 1e9 / updateCount, (double)handleMetrics.rotations / updateCount);
+    printf("Delete + insert:        %7.1f ns/update, %.2f rotations/update\n",
+           reinsertMetrics.time_taken * 1e9 / updateCount, (double)reinsertMetrics.rotations / updateCount);
+    
+    long total = 0;
+    for (int i = 0; i <= size; i++) {
+        total += records[i];
+    }
+    printf("\nHandle records updated: %ld of %d\n\n", total, updateCount);
+    
+    avlmap_free(upsertRoot);
+    avlmap_free(slotRoot);
+    avlmap_free(reinsertRoot);
+    handlemap_free(handleRoot);
+    free(records);
+    free(updates);
+    free(keys);
+}
+
+typedef struct { // best-of-rounds timings for one instrumentation variant
+    double insert;
+    double search;
+    double remove;
+} OverheadTiming;
+
+void keepFastest(OverheadTiming* best, double insertTime, double searchTime, double removeTime) {
+    if (best->insert == 0.0 || insertTime < best->insert) {
+        best->insert = insertTime;
+    }
+    if (best->search == 0.0 || searchTime < best->search) {
+        best->search = searchTime;
+    }
+    if (best->remove == 0.0 || removeTime < best->remove) {
+        best->remove = removeTime;
+    }
+}
+
+void printOverhead(char* operation, double counted, double bare, int ops) {
+    printf("%-8s counted %7.1f ns/op, bare %7.1f ns/op, overhead %+.1f%%\n", operation,
+           counted * 1e9 / ops, bare * 1e9 / ops, (counted - bare) / bare * 100);
+}
+
+// cost of the metrics counters: same generic avl with counters on and off
+void runOverheadExperiment(int size, int rounds) {
+    int* keys = (int*)malloc(size * sizeof(int));
+    int* queries = (int*)malloc(size * sizeof(int));
+    
+    if (keys == NULL || queries == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(keys, size);
+    shuffleArray(keys, size);
+    for (int i = 0; i < size; i++) {
+        queries[i] = keys[i];
+    }
+    shuffleArray(queries, size);
+    
+    printHeader("INSTRUMENTATION OVERHEAD EXPERIMENT");
+    printf("Keys: %d, rounds: %d (best round reported)\n", size, rounds);
+    printf("This build: TREE_METRICS=%d, hand-written trees are %s\n\n", TREE_METRICS,
+           TREE_METRICS ? "instrumented" : "uninstrumented");
+    
+    OverheadTiming counted = {0.0, 0.0, 0.0};
+    OverheadTiming bare = {0.0, 0.0, 0.0};
+    long found = 0;
+    
+    for (int r = 0; r < rounds; r++) { // alternate variants so neither always gets fresh memory
+        AVLMetrics metrics = {0};
+        CountedAVLNode* countedRoot = NULL;
+        double start = nowSeconds();
+        for (int i = 0; i < size; i++) {
+            countedRoot = countedavl_insert(countedRoot, keys[i], i, &metrics);
+        }
+        double insertTime = nowSeconds() - start;
+        start = nowSeconds();
+        for (int i = 0; i < size; i++) {
+            found += countedavl_search(countedRoot, queries[i], &metrics) != NULL;
+        }
+        double searchTime = nowSeconds() - start;
+        start = nowSeconds();
+        for (int i = 0; i < size; i++) {
+            countedRoot = countedavl_delete(countedRoot, queries[i], &metrics);
+        }
+        keepFastest(&counted, insertTime, searchTime, nowSeconds() - start);
+        
+        BareAVLNode* bareRoot = NULL;
+        start = nowSeconds();
+        for (int i = 0; i < size; i++) {
+            bareRoot = bareavl_insert(bareRoot, keys[i], i, &metrics);
+        }
+        insertTime = nowSeconds() - start;
+        start = nowSeconds();
+        for (int i = 0; i < size; i++) {
+            found += bareavl_search(bareRoot, queries[i], &metrics) != NULL;
+        }
+        searchTime = nowSeconds() - start;
+        start = nowSeconds();
+        for (int i = 0; i < size; i++) {
+            bareRoot = bareavl_delete(bareRoot, queries[i], &metrics);
+        }
+        keepFastest(&bare, insertTime, searchTime, nowSeconds() - start);
+    }
+    
+    printOverhead("Insert", counted.insert, bare.insert, size);
+    printOverhead("Search", counted.search, bare.search, size);
+    printOverhead("Delete", counted.remove, bare.remove, size);
+    printf("Found %ld of %ld lookups\n\n", found, 2L * rounds * size);
+    
+    free(queries);
+    free(keys);
+}
+
+// process start: rebuild from raw keys with avl_insert vs reload a saved tree
+void runStartupExperiment(int maxSize, char* path) {
+    printHeader("STARTUP EXPERIMENT: INSERT REBUILD vs SAVED TREE");
+    printf("File: %s, header %zu bytes + %zu bytes per key\n\n", path,
+           sizeof(AVLFileHeader), sizeof(int));
+    printf("%10s %12s %10s %10s %10s %8s %8s\n", "Keys", "Inserts s", "Save s",
+           "Load s", "Speedup", "Height", "Loaded");
+    
+    int firstSize = maxSize < 1000000 ? maxSize : 1000000; // a small maxSize still gets one row
+    for (int size = firstSize; size <= maxSize && size > 0; size = size <= INT32_MAX / 10 ? size * 10 : -1) {
+        int* keys = (int*)malloc(size * sizeof(int));
+        
+        if (keys == NULL) {
+            printf("Memory allocation failed!\n");
+            exit(1);
+        }
+        
+        generateSortedData(keys, size);
+        shuffleArray(keys, size);
+        
+        AVLMetrics metrics = {0};
+        AVLNode* root = NULL;
+        double start = nowSeconds();
+        for (int i = 0; i < size; i++) {
+            root = avl_insert(root, keys[i], &metrics);
+        }
+        double insertTime = nowSeconds() - start;
+        free(keys);
+        
+        start = nowSeconds();
+        int saved = avl_save(root, path);
+        double saveTime = nowSeconds() - start;
+        freeAVL(root);
+        
+        if (saved != size) {
+            printf("Could not write %s\n", path);
+            return;
+        }
+        
+        start = nowSeconds();
+        int loaded = avl_load(path, &root);
+        double loadTime = nowSeconds() - start;
+        
+        printf("%10d %12.3f %10.3f %10.3f %9.1fx %8d %8s\n", size, insertTime, saveTime,
+               loadTime, insertTime / loadTime, avl_height(root), loaded == size ? "OK" : "FAILED");
+        freeAVL(root);
+    }
+    
+    remove(path);
+    printf("\n");
+}
+
+int dropPageCache(const char* path) { // best effort, 1 if the kernel was asked to evict the file
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    int ok = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return ok;
+}
+
+// lookups straight off a mapped image vs loading the tree first, cold and warm page cache
+void runImageExperiment(int size, int lookups, char* path) {
+    int* keys = (int*)malloc(size * sizeof(int));
+    int* queries = (int*)malloc(lookups * sizeof(int));
+    
+    if (keys == NULL || queries == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(keys, size);
+    for (int i = 0; i < lookups; i++) {
+        queries[i] = keys[rand() % size];
+    }
+    
+    char savePath[1024];
+    snprintf(savePath, sizeof(savePath), "%s.keys", path);
+    
+    AVLNode* root = avl_build_sorted(keys, size);
+    if (avl_image_write(root, path) != size || avl_save(root, savePath) != size) {
+        printf("Could not write %s\n", path);
+        exit(1);
+    }
+    freeAVL(root);
+    
+    printHeader("MAPPED IMAGE EXPERIMENT: ZERO-COPY STARTUP");
+    printf("Keys: %d, lookups: %d, image %zu bytes per node, file %s\n", size, lookups,
+           sizeof(AVLImageNode), path);
+    int cold = dropPageCache(path) && dropPageCache(savePath);
+    printf("Page cache: %s\n\n", cold ? "dropped before the cold runs" : "could not drop, cold runs may be warm");
+    
+    AVLMetrics metrics = {0};
+    AVLImage image;
+    long found = 0;
+    
+    double start = nowSeconds(); // cold: open, then lookups fault pages in
+    if (!avl_image_open(&image, path)) {
+        printf("Could not map %s\n", path);
+        exit(1);
+    }
+    double openTime = nowSeconds() - start;
+    found += avl_image_search(&image, queries[0], &metrics) != NULL;
+    double firstTime = nowSeconds() - start;
+    for (int i = 1; i < lookups; i++) {
+        found += avl_image_search(&image, queries[i], &metrics) != NULL;
+    }
+    double coldTime = nowSeconds() - start - firstTime;
+    
+    start = nowSeconds(); // warm: same lookups, pages resident
+    for (int i = 0; i < lookups; i++) {
+        found += avl_image_search(&image, queries[i], &metrics) != NULL;
+    }
+    double warmTime = nowSeconds() - start;
+    avl_image_close(&image);
+    
+    start = nowSeconds(); // the same keys through avl_load, cold
+    if (avl_load(savePath, &root) != size) {
+        printf("Could not load %s\n", savePath);
+        exit(1);
+    }
+    double loadTime = nowSeconds() - start;
+    found += avl_search(root, queries[0], &metrics) != NULL;
+    double loadFirstTime = nowSeconds() - start;
+    start = nowSeconds();
+    for (int i = 0; i < lookups; i++) {
+        found += avl_search(root, queries[i], &metrics) != NULL;
+    }
+    double loadedTime = nowSeconds() - start;
+    freeAVL(root);
+    
+    printf("%-22s %12s %14s %14s %14s\n", "", "Open s", "First lookup s", "Cold ns/lookup", "Warm ns/lookup");
+    printf("%-22s %12.6f %14.6f %14.1f %14.1f\n", "mmap image", openTime, firstTime,
+           coldTime * 1e9 / (lookups > 1 ? lookups - 1 : 1), warmTime * 1e9 / lookups);
+    printf("%-22s %12.6f %14.6f %14s %14.1f\n", "avl_load + avl_search", loadTime, loadFirstTime,
+           "-", loadedTime * 1e9 / lookups);
+    printf("Found %ld of %ld lookups\n\n", found, 3L * lookups + 1);
+    
+    remove(savePath);
+    remove(path);
+    free(queries);
+    free(keys);
+}
+
+int countAVLNodes(AVLNode* root) {
+    if (root == NULL) {
+        return 0;
+    }
+    return countAVLNodes(root->left) + countAVLNodes(root->right) + 1;
+}
+
+// durable updates: ops/sec per group-commit batch size, then checkpoint and recovery
+void runWALExperiment(int ops, char* dir, long checkpointEvery) {
+    int batchSizes[] = {1, 8, 64, 512};
+    int numBatchSizes = 4;
+    int keySpace = ops > 1 ? ops / 2 : 1; // small key space so deletes hit
+    char logPath[WAL_PATH_MAX];
+    char checkpointPath[WAL_PATH_MAX];
+    
+    snprintf(logPath, sizeof(logPath), "%s/avl_wal.log", dir);
+    snprintf(checkpointPath, sizeof(checkpointPath), "%s/avl_wal.ckpt", dir);
+    
+    printHeader("WAL EXPERIMENT: GROUP COMMIT AND RECOVERY");
+    printf("Ops: %d (70%% insert, 30%% delete), checkpoint every %ld records, log %s\n\n", ops,
+           checkpointEvery, logPath);
+    printf("%8s %10s %8s %12s %10s %14s %12s %10s\n", "Batch", "Fsyncs", "Ckpts", "Ops/sec",
+           "Keys", "Checkpoint s", "Recover s", "Recovered");
+    
+    for (int b = 0; b < numBatchSizes; b++) {
+        remove(logPath);
+        remove(checkpointPath);
+        
+        WAL wal;
+        AVLNode* root = NULL;
+        AVLMetrics metrics = {0};
+        if (wal_open(&wal, logPath, checkpointPath, batchSizes[b], checkpointEvery, &root) < 0) {
+            printf("Could not open %s\n", logPath);
+            return;
+        }
+        
+        double start = nowSeconds();
+        for (int i = 0; i < ops; i++) {
+            int key = rand() % keySpace;
+            if (rand() % 10 < 7) {
+                root = wal_insert(&wal, root, key, &metrics);
+            } else {
+                root = wal_delete(&wal, root, key, &metrics);
+            }
+        }
+        wal_commit(&wal);
+        double runTime = nowSeconds() - start;
+        
+        for (int i = 0; i < ops / 10; i++) { // a tail that only lives in the log
+            root = wal_insert(&wal, root, keySpace + i, &metrics);
+        }
+        start = nowSeconds();
+        int checkpointed = wal_checkpoint(&wal, root);
+        double checkpointTime = nowSeconds() - start;
+        for (int i = 0; i < ops / 10; i++) {
+            root = wal_delete(&wal, root, keySpace + i, &metrics);
+        }
+        long syncs = wal.syncs;
+        long checkpoints = wal.checkpoints;
+        long logTail = wal.since_checkpoint; // what recovery has to replay on top of the checkpoint
+        wal_close(&wal);
+        int keys = countAVLNodes(root);
+        
+        AVLNode* recovered = NULL; // reopen as after a restart: checkpoint plus log tail
+        start = nowSeconds();
+        long replayed = wal_open(&wal, logPath, checkpointPath, batchSizes[b], checkpointEvery,
+                                 &recovered);
+        double recoverTime = nowSeconds() - start;
+        
+        int match = checkpointed && replayed == logTail && countAVLNodes(recovered) == keys &&
+                    (checkpointEvery == 0 || checkpoints > 1); // periodic ones ran besides ours
+        AVLCursor expected, actual;
+        avl_cursor_first(&expected, root);
+        avl_cursor_first(&actual, recovered);
+        while (match && avl_cursor_valid(&expected) && avl_cursor_valid(&actual)) {
+            match = avl_cursor_node(&expected)->data == avl_cursor_node(&actual)->data;
+            avl_cursor_next(&expected);
+            avl_cursor_next(&actual);
+        }
+        
+        printf("%8d %10ld %8ld %12.0f %10d %14.6f %12.6f %10s\n", batchSizes[b], syncs, checkpoints,
+               ops / runTime, keys, checkpointTime, recoverTime, match ? "PASS" : "FAIL");
+        
+        if (replayed >= 0) {
+            wal_close(&wal);
+        }
+        freeAVL(recovered);
+        freeAVL(root);
+    }
+    
+    remove(logPath);
+    remove(checkpointPath);
+    printf("\n");
+}
+
+// every (structure, dataset, size, seed) cell on a pinned worker pool; workers 1 = serial
+void runMatrixExperiment(int workers, int maxSize, int seeds) {
+    int sizes[] = {1000, 10000, 100000, 1000000};
+    int numSizes = 0;
+    while (numSizes < 4 && sizes[numSizes] <= maxSize) {
+        numSizes++;
+    }
+    
+    int count = numSizes * DATASET_TYPES * ordered_set_count() * seeds;
+    MatrixCell* cells = (MatrixCell*)calloc(count > 0 ? count : 1, sizeof(MatrixCell));
+    
+    if (cells == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    int c = 0;
+    for (int z = 0; z < numSizes; z++) {
+        for (int d = 0; d < DATASET_TYPES; d++) {
+            for (int s = 0; s < ordered_set_count(); s++) {
+                for (int k = 0; k < seeds; k++) {
+                    cells[c].set = s;
+                    cells[c].dataset = (DatasetType)d;
+                    cells[c].size = sizes[z];
+                    cells[c].seed = 1000003u * (k + 1) + sizes[z]; // same data for every structure
+                    c++;
+                }
+            }
+        }
+    }
+    
+    printHeader("BENCHMARK MATRIX");
+    double start = nowSeconds();
+    int used = matrix_run(cells, count, workers);
+    double wallTime = nowSeconds() - start;
+    
+    printf("Cells: %d, workers: %d of %d cpus (%s), wall time %.3f s\n\n", count, used,
+           matrix_cpus(), used == 1 ? "serial, one cell at a time" : "pinned, one per cpu", wallTime);
+    matrix_print_summary(cells, count);
+    printf("\n");
+    matrix_print_csv(cells, count);
+    printf("\n");
+    
+    free(cells);
+}
+
+// group-prefetched batch lookups vs one avl_search at a time, on a tree bigger than cache
+void runBatchLookupExperiment(int size, int lookups) {
+    int batchSizes[] = {1, 2, 4, 8, 16, 32, 64};
+    int numBatchSizes = 7;
+    int* keys = (int*)malloc(size * sizeof(int));
+    int* queries = (int*)malloc(lookups * sizeof(int));
+    AVLNode** results = (AVLNode**)malloc(lookups * sizeof(AVLNode*));
+    
+    if (keys == NULL || queries == NULL || results == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(keys, size);
+    shuffleArray(keys, size); // random insertion order scatters the nodes over the heap
+    for (int i = 0; i < lookups; i++) {
+        queries[i] = rand() % (size + size / 4) + 1; // about 20% misses
+    }
+    
+    AVLMetrics metrics = {0};
+    MemStats memory;
+    memtrack_begin(&memory);
+    AVLNode* root = NULL;
+    for (int i = 0; i < size; i++) {
+        root = avl_insert(root, keys[i], &metrics);
+    }
+    memtrack_end(&memory);
+    
+    printHeader("BATCHED LOOKUP EXPERIMENT: GROUP PREFETCH");
+    printf("Keys: %d (%.1f MB of nodes), lookups: %d, height %d\n\n", size,
+           memory.live_bytes / 1048576.0, lookups, avl_height(root));
+    
+    long expected = 0;
+    double start = nowSeconds();
+    for (int i = 0; i < lookups; i++) {
+        expected += avl_search(root, queries[i], &metrics) != NULL;
+    }
+    double baseTime = nowSeconds() - start;
+    printf("%-12s %14s %10s %8s\n", "Batch", "Lookups/sec", "Speedup", "Found");
+    printf("%-12s %14.0f %9.2fx %8ld\n", "avl_search", lookups / baseTime, 1.0, expected);
+    
+    for (int b = 0; b < numBatchSizes; b++) {
+        start = nowSeconds();
+        avl_search_batch(root, queries, lookups, results, batchSizes[b], &metrics);
+        double batchTime = nowSeconds() - start;
+        
+        long found = 0;
+        for (int i = 0; i < lookups; i++) {
+            found += results[i] != NULL && results[i]->data == queries[i];
+        }
+        printf("%-12d %14.0f %9.2fx %8ld%s\n", batchSizes[b], lookups / batchTime,
+               baseTime / batchTime, found, found == expected ? "" : " MISMATCH");
+    }
+    printf("\n");
+    
+    freeAVL(root);
+    free(results);
+    free(queries);
+    free(keys);
+}
+
+// pointer AVL vs Eytzinger array vs vEB layout, from L1-sized sets upward
+void runLayoutExperiment(int maxSize, int lookups) {
+    int* queries = (int*)malloc(lookups * sizeof(int));
+    
+    if (queries == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    printHeader("STATIC LAYOUT EXPERIMENT: POINTER vs EYTZINGER vs vEB");
+    printf("Lookups per size: %d (all hits), ns per lookup\n\n", lookups);
+    printf("%10s %10s %12s %12s %12s\n", "Keys", "AVL MB", "AVL", "Eytzinger", "vEB");
+    
+    for (int size = 4096; size <= maxSize && size > 0; size = size <= INT32_MAX / 8 ? size * 8 : -1) {
+        int* keys = (int*)malloc(size * sizeof(int));
+        
+        if (keys == NULL) {
+            printf("Memory allocation failed!\n");
+            exit(1);
+        }
+        
+        generateSortedData(keys, size);
+        shuffleArray(keys, size); // pointer tree as built by random inserts
+        
+        AVLMetrics metrics = {0};
+        MemStats memory;
+        memtrack_begin(&memory);
+        AVLNode* root = NULL;
+        for (int i = 0; i < size; i++) {
+            root = avl_insert(root, keys[i], &metrics);
+        }
+        memtrack_end(&memory);
+        
+        avl_inorder_keys(root, keys, size); // the static layouts start from the tree's in-order keys
+        EytzingerArray* eytzinger = eytzinger_build(keys, size);
+        VEBTree* veb = veb_build(keys, size);
+        for (int i = 0; i < lookups; i++) {
+            queries[i] = keys[rand() % size];
+        }
+        
+        long found = 0;
+        double start = nowSeconds();
+        for (int i = 0; i < lookups; i++) {
+            found += avl_search(root, queries[i], &metrics) != NULL;
+        }
+        double avlTime = nowSeconds() - start;
+        
+        start = nowSeconds();
+        for (int i = 0; i < lookups; i++) {
+            found += eytzinger_search(eytzinger, queries[i], &metrics) != 0;
+        }
+        double eytzingerTime = nowSeconds() - start;
+        
+        start = nowSeconds();
+        for (int i = 0; i < lookups; i++) {
+            found += veb_search(veb, queries[i], &metrics) != NULL;
+        }
+        double vebTime = nowSeconds() - start;
+        
+        printf("%10d %10.1f %12.1f %12.1f %12.1f%s\n", size, memory.live_bytes / 1048576.0,
+               avlTime * 1e9 / lookups, eytzingerTime * 1e9 / lookups, vebTime * 1e9 / lookups,
+               found == 3L * lookups ? "" : " MISSED KEYS");
+        
+        freeVEB(veb);
+        freeEytzinger(eytzinger);
+        freeAVL(root);
+        free(keys);
+    }
+    
+    printf("Bytes per key: AVL %zu + malloc overhead, Eytzinger %zu, vEB %zu\n\n",
+           sizeof(AVLNode), sizeof(int), sizeof(VEBNode));
+    free(queries);
+}
+
+long anonHugePagesKb() { // process-wide, from /proc/self/smaps_rollup; -1 if unavailable
+    FILE* file = fopen("/proc/self/smaps_rollup", "r");
+    char line[256];
+    long kb = -1;
+    
+    if (file == NULL) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (strncmp(line, "AnonHugePages:", 14) == 0) {
+            kb = strtol(line + 14, NULL, 10);
+        }
+    }
+    fclose(file);
+    return kb;
+}
+
+// malloc'ed nodes vs arena nodes on base pages, THP and hugetlbfs: lookup time and dTLB misses
+void runHugePageExperiment(int size, int lookups) {
+    int* keys = (int*)malloc(size * sizeof(int));
+    int* queries = (int*)malloc(lookups * sizeof(int));
+    
+    if (keys == NULL || queries == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(keys, size);
+    shuffleArray(keys, size);
+    for (int i = 0; i < lookups; i++) {
+        queries[i] = keys[rand() % size];
+    }
+    
+    int tlbCounter = perf_counter_open(PERF_DTLB_LOAD_MISSES);
+    
+    printHeader("HUGE PAGE ARENA EXPERIMENT");
+    printf("Keys: %d, lookups: %d (best of 3), dTLB counter: %s\n\n", size, lookups,
+           tlbCounter >= 0 ? "perf_event_open" : "unavailable");
+    printf("%-18s %-18s %10s %12s %12s %14s\n", "Nodes from", "Pages", "MB", "Huge kB",
+           "ns/lookup", "dTLB miss/op");
+    
+    for (int variant = -1; variant <= ARENA_HUGETLB; variant++) { // -1 is plain malloc
+        NodeArena arena;
+        if (variant >= 0) {
+            arena_init(&arena, sizeof(AVLNode), (ArenaPages)variant);
+            avl_use_arena(&arena);
+        }
+        
+        AVLMetrics metrics = {0};
+        MemStats memory;
+        memtrack_begin(&memory);
+        AVLNode* root = NULL;
+        for (int i = 0; i < size; i++) {
+            root = avl_insert(root, keys[i], &metrics);
+        }
+        memtrack_end(&memory);
+        
+        long found = 0;
+        double lookupTime = 0.0;
+        long long misses = -1;
+        for (int round = 0; round < 3; round++) { // best of three, this is noisy on shared machines
+            found = 0;
+            perf_counter_start(tlbCounter);
+            double start = nowSeconds();
+            for (int i = 0; i < lookups; i++) {
+                found += avl_search(root, queries[i], &metrics) != NULL;
+            }
+            double roundTime = nowSeconds() - start;
+            long long roundMisses = perf_counter_stop(tlbCounter);
+            if (round == 0 || roundTime < lookupTime) {
+                lookupTime = roundTime;
+                misses = roundMisses;
+            }
+        }
+        
+        char missText[32];
+        if (misses >= 0) {
+            snprintf(missText, sizeof(missText), "%.3f", (double)misses / lookups);
+        } else {
+            snprintf(missText, sizeof(missText), "n/a");
+        }
+        
+        printf("%-18s %-18s %10.1f %12ld %12.1f %14s%s\n", variant < 0 ? "malloc" : "arena",
+               variant < 0 ? "allocator default" : arena_pages_name(arena.backing),
+               (variant < 0 ? memory.live_bytes : arena.bytes_mapped) / 1048576.0,
+               anonHugePagesKb(), lookupTime * 1e9 / lookups, missText,
+               found == lookups ? "" : " MISSED KEYS");
+        
+        freeAVL(root);
+        if (variant >= 0) {
+            avl_use_arena(NULL);
+            arena_release(&arena);
+        }
+    }
+    
+    printf("\n");
+    perf_counter_close(tlbCounter);
+    free(queries);
+    free(keys);
+}
+
+double bestLookupTime(AVLNode* root, int* queries, int lookups, long* found) { // best of three
+    AVLMetrics metrics = {0};
+    double best = 0.0;
+    
+    for (int round = 0; round < 3; round++) {
+        *found = 0;
+        double start = nowSeconds();
+        for (int i = 0; i < lookups; i++) {
+            *found += avl_search(root, queries[i], &metrics) != NULL;
+        }
+        double elapsed = nowSeconds() - start;
+        if (round == 0 || elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+// long-lived tree: churn scatters the nodes, compaction lays them out again
+void runCompactionExperiment(int size, int rounds, int lookups) {
+    int keySpace = 4 * size;
+    int* queries = (int*)malloc(lookups * sizeof(int));
+    
+    if (queries == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    AVLMetrics metrics = {0};
+    AVLNode* root = NULL;
+    for (int i = 1; i <= size; i++) { // ascending inserts: nodes start out in key order
+        root = avl_insert(root, 4 * i, &metrics);
+    }
+    for (int i = 0; i < lookups; i++) {
+        queries[i] = 4 * (rand() % size + 1);
+    }
+    
+    printHeader("COMPACTION EXPERIMENT: CHURN THEN RELOCATE");
+    printf("Keys: %d, churn rounds: %d of %d delete+insert, lookups: %d (best of 3)\n\n",
+           size, rounds, size / 10, lookups);
+    printf("%-28s %12s %10s\n", "Layout", "ns/lookup", "Found");
+    
+    long found;
+    double lookupTime = bestLookupTime(root, queries, lookups, &found);
+    printf("%-28s %12.1f %10ld\n", "fresh (ascending inserts)", lookupTime * 1e9 / lookups, found);
+    
+    for (int r = 0; r < rounds; r++) { // random deletes and inserts reuse freed chunks all over the heap
+        for (int i = 0; i < size / 10; i++) {
+            root = avl_delete(root, 4 * (rand() % (keySpace / 4) + 1), &metrics);
+            root = avl_insert(root, 4 * (rand() % (keySpace / 4) + 1), &metrics);
+        }
+    }
+    int* present = (int*)malloc(keySpace * sizeof(int));
+    if (present == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    int live = avl_inorder_keys(root, present, keySpace);
+    for (int i = 0; i < lookups; i++) { // lookups for keys still present
+        queries[i] = present[rand() % live];
+    }
+    free(present);
+    
+    lookupTime = bestLookupTime(root, queries, lookups, &found);
+    printf("%-28s %12.1f %10ld\n", "after churn (malloc)", lookupTime * 1e9 / lookups, found);
+    
+    NodeArena dfsArena;
+    arena_init(&dfsArena, sizeof(AVLNode), ARENA_THP);
+    double start = nowSeconds();
+    root = avl_compact(root, &dfsArena, AVL_COMPACT_DFS); // old nodes still belong to malloc
+    double compactTime = nowSeconds() - start;
+    avl_use_arena(&dfsArena);
+    lookupTime = bestLookupTime(root, queries, lookups, &found);
+    printf("%-28s %12.1f %10ld   (compaction %.3f s)\n", "compacted, DFS order",
+           lookupTime * 1e9 / lookups, found, compactTime);
+    
+    NodeArena vebArena;
+    arena_init(&vebArena, sizeof(AVLNode), ARENA_THP);
+    start = nowSeconds();
+    root = avl_compact(root, &vebArena, AVL_COMPACT_VEB);
+    compactTime = nowSeconds() - start;
+    avl_use_arena(&vebArena);
+    arena_release(&dfsArena);
+    lookupTime = bestLookupTime(root, queries, lookups, &found);
+    printf("%-28s %12.1f %10ld   (compaction %.3f s)\n", "compacted, vEB order",
+           lookupTime * 1e9 / lookups, found, compactTime);
+    printf("\n");
+    
+    freeAVL(root);
+    avl_use_arena(NULL);
+    arena_release(&vebArena);
+    free(queries);
+}
+
+int checkAVLShape(AVLNode* root, long lo, long hi, int* ok) { // height, clears *ok on any broken invariant
+    if (root == NULL) {
+        return 0;
+    }
+    if (root->data <= lo || root->data >= hi) {
+        *ok = 0;
+    }
+    int leftHeight = checkAVLShape(root->left, lo, root->data, ok);
+    int rightHeight = checkAVLShape(root->right, root->data, hi, ok);
+    int h = (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+    if (root->height != h || leftHeight - rightHeight > 1 || rightHeight - leftHeight > 1) {
+        *ok = 0;
+    }
+#if AVL_ORDER_STATS
+    if (root->size != countAVLNodes(root)) {
+        *ok = 0;
+    }
+#endif
+    return h;
+}
+
+// node handles from avl_search must survive deletes of other keys
+void runHandleExperiment(int size) {
+    int* keys = (int*)malloc(size * sizeof(int));
+    AVLNode** handles = (AVLNode**)malloc(size * sizeof(AVLNode*));
+    
+    if (keys == NULL || handles == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(keys, size);
+    shuffleArray(keys, size);
+    
+    AVLMetrics metrics = {0};
+    AVLNode* root = NULL;
+    for (int i = 0; i < size; i++) {
+        root = avl_insert(root, keys[i], &metrics);
+    }
+    for (int i = 0; i < size; i++) {
+        handles[keys[i] - 1] = avl_search(root, keys[i], &metrics);
+    }
+    
+    shuffleArray(keys, size); // handles[k - 1] belongs to key k
+    double start = nowSeconds();
+    for (int i = 0; i < size / 2; i++) {
+        root = avl_delete(root, keys[i], &metrics);
+    }
+    double deleteTime = nowSeconds() - start;
+    
+    int stable = 1;
+    for (int i = size / 2; i < size; i++) { // survivors: same node, same key
+        AVLNode* handle = handles[keys[i] - 1];
+        if (handle->data != keys[i] || avl_search(root, keys[i], &metrics) != handle) {
+            stable = 0;
+        }
+    }
+    int shape = 1;
+    checkAVLShape(root, (long)INT_MIN - 1, (long)INT_MAX + 1, &shape);
+    
+    long sum = 0;
+    start = nowSeconds();
+    for (int i = size / 2; i < size; i++) {
+        sum += avl_search(root, keys[i], &metrics)->data;
+    }
+    double searchTime = nowSeconds() - start;
+    start = nowSeconds();
+    for (int i = size / 2; i < size; i++) {
+        sum -= handles[keys[i] - 1]->data;
+    }
+    double handleTime = nowSeconds() - start;
+    int survivors = size - size / 2;
+    
+    printHeader("HANDLE STABILITY EXPERIMENT");
+    printf("Keys: %d, deleted: %d in random order\n\n", size, size / 2);
+    printf("Deletes:              %.0f ops/s\n", (size / 2) / deleteTime);
+    printf("Access via search:    %.1f ns/key\n", searchTime * 1e9 / survivors);
+    printf("Access via handle:    %.1f ns/key\n", handleTime * 1e9 / survivors);
+    printf("Handles stable:       %s\n", stable && sum == 0 ? "PASS" : "FAIL");
+    printf("AVL invariants:       %s\n\n", shape ? "PASS" : "FAIL");
+    
+    freeAVL(root);
+    free(handles);
+    free(keys);
+}
+
+typedef struct { // caller-owned record with the tree link inside
+    int key;
+    AVLLink link;
+    char payload[16];
+} LinkedRecord;
+
+int compareRecords(const AVLLink* a, const AVLLink* b) {
+    int x = avl_link_entry(a, LinkedRecord, link)->key;
+    int y = avl_link_entry(b, LinkedRecord, link)->key;
+    return (x > y) - (x < y);
+}
+
+// records the caller already owns: the intrusive tree links them, avl_insert allocates a node per key
+void runIntrusiveExperiment(int size, int rounds) {
+    LinkedRecord* records = (LinkedRecord*)malloc(size * sizeof(LinkedRecord));
+    int* order = (int*)malloc(size * sizeof(int));
+    
+    if (records == NULL || order == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(order, size);
+    shuffleArray(order, size);
+    for (int i = 0; i < size; i++) {
+        records[i].key = i + 1;
+        memset(records[i].payload, 0, sizeof(records[i].payload));
+    }
+    
+    double nodeInsert = 0.0, nodeRemove = 0.0, linkInsert = 0.0, linkRemove = 0.0;
+    MemStats nodeMemory, linkMemory;
+    int consistent = 1;
+    
+    for (int round = 0; round < rounds; round++) { // best of rounds
+        AVLMetrics metrics = {0};
+        memtrack_begin(&nodeMemory);
+        double start = nowSeconds();
+        AVLNode* root = NULL;
+        for (int i = 0; i < size; i++) {
+            root = avl_insert(root, records[order[i] - 1].key, &metrics);
+        }
+        double insertTime = nowSeconds() - start;
+        int nodeHeight = avl_height(root);
+        start = nowSeconds();
+        for (int i = 0; i < size; i++) {
+            root = avl_delete(root, order[i], &metrics);
+        }
+        double removeTime = nowSeconds() - start;
+        memtrack_end(&nodeMemory);
+        
+        memtrack_begin(&linkMemory);
+        AVLLinkTree tree;
+        avl_link_init(&tree, compareRecords);
+        start = nowSeconds();
+        for (int i = 0; i < size; i++) {
+            avl_link_insert(&tree, &records[order[i] - 1].link, &metrics);
+        }
+        double linkInsertTime = nowSeconds() - start;
+        int linkHeight = avl_link_height(&tree);
+        LinkedRecord probe;
+        for (int i = 0; i < size; i++) {
+            probe.key = order[i];
+            if (avl_link_find(&tree, &probe.link, &metrics) != &records[order[i] - 1].link) {
+                consistent = 0;
+            }
+        }
+        start = nowSeconds();
+        for (int i = 0; i < size; i++) {
+            probe.key = order[i];
+            avl_link_remove(&tree, &probe.link, &metrics);
+        }
+        double linkRemoveTime = nowSeconds() - start;
+        memtrack_end(&linkMemory);
+        
+        if (nodeHeight != linkHeight || tree.root != NULL) { // same insertion order, same shape
+            consistent = 0;
+        }
+        if (round == 0 || insertTime < nodeInsert) {
+            nodeInsert = insertTime;
+        }
+        if (round == 0 || removeTime < nodeRemove) {
+            nodeRemove = removeTime;
+        }
+        if (round == 0 || linkInsertTime < linkInsert) {
+            linkInsert = linkInsertTime;
+        }
+        if (round == 0 || linkRemoveTime < linkRemove) {
+            linkRemove = linkRemoveTime;
+        }
+    }
+    
+    printHeader("INTRUSIVE AVL EXPERIMENT");
+    printf("Records: %d (%zu bytes each, caller-owned), random order, best of %d\n\n",
+           size, sizeof(LinkedRecord), rounds);
+    printf("%-22s %14s %14s %12s\n", "API", "inserts/s", "removes/s", "Allocations");
+    printf("%-22s %14.0f %14.0f %12ld\n", "avl_insert (nodes)", size / nodeInsert, size / nodeRemove,
+           nodeMemory.allocations);
+    printf("%-22s %14.0f %14.0f %12ld\n", "avl_link_insert", size / linkInsert, size / linkRemove,
+           linkMemory.allocations);
+    printf("\nSame shape and every record found: %s\n\n", consistent ? "PASS" : "FAIL");
+    
+    free(order);
+    free(records);
+}
+
+// rebalancing cases and how far each update's height change climbed, as CSV
+void runRetraceExperiment(int size, unsigned int seed) {
+    int* keys = (int*)malloc(size * sizeof(int));
+    AVLMetrics* rows = (AVLMetrics*)calloc(2 * DATASET_TYPES, sizeof(AVLMetrics));
+    
+    if (keys == NULL || rows == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    for (int type = 0; type < DATASET_TYPES; type++) {
+        generateSeededData(keys, size, (DatasetType)type, seed);
+        AVLNode* root = NULL;
+        for (int i = 0; i < size; i++) {
+            root = avl_insert(root, keys[i], &rows[2 * type]);
+        }
+        shuffleSeeded(keys, size, seed);
+        for (int i = 0; i < size; i++) {
+            root = avl_delete(root, keys[i], &rows[2 * type + 1]);
+        }
+    }
+    
+    int levels = 1; // histogram columns up to the highest level any update reached
+    for (int row = 0; row < 2 * DATASET_TYPES; row++) {
+        for (int level = 0; level < AVL_MAX_HEIGHT; level++) {
+            if (rows[row].stop_level[level] > 0 && level + 1 > levels) {
+                levels = level + 1;
+            }
+        }
+    }
+    
+    printf("dataset,phase,size,updates,rotations,ll_rotations,rr_rotations,lr_rotations,"
+           "rl_rotations,retrace_steps,retrace_per_update");
+    for (int level = 0; level < levels; level++) {
+        printf(",stop_%d", level);
+    }
+    printf("\n");
+    for (int row = 0; row < 2 * DATASET_TYPES; row++) {
+        AVLMetrics* m = &rows[row];
+        printf("%s,%s,%d,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%.3f", datasetTypeName((DatasetType)(row / 2)),
+               row % 2 == 0 ? "insert" : "delete", size, m->retrace_ops, m->rotations,
+               m->ll_rotations, m->rr_rotations, m->lr_rotations, m->rl_rotations, m->retrace_steps,
+               m->retrace_ops > 0 ? (double)m->retrace_steps / m->retrace_ops : 0.0);
+        for (int level = 0; level < levels; level++) {
+            printf(",%ld", m->stop_level[level]);
+        }
+        printf("\n");
+    }
+    
+    free(rows);
+    free(keys);
+}
+
+// duplicate chains: every value kept per key, newest first, node gone with the last one
+void runMultimapExperiment(int keys, int duplicates) {
+    AVLMetrics metrics = {0};
+    MemStats memory;
+    AVLMultimapNode* root = NULL;
+    int ok = 1;
+    
+    memtrack_begin(&memory);
+    double start = nowSeconds();
+    for (int j = 0; j < duplicates; j++) { // rounds, so each chain grows one entry at a time
+        for (int k = 0; k < keys; k++) {
+            root = multimap_add(root, k, k * duplicates + j, &metrics);
+        }
+    }
+    double addTime = nowSeconds() - start;
+    
+    for (int k = 0; k < keys; k++) { // chain length and order
+        DuplicateChain* chain = multimap_get(root, k, &metrics);
+        int length = 0;
+        for (DuplicateEntry* entry = chain ? chain->head : NULL; entry != NULL; entry = entry->next) {
+            ok = ok && entry->value == k * duplicates + (duplicates - 1 - length);
+            length++;
+        }
+        ok = ok && chain != NULL && chain->count == duplicates && length == duplicates &&
+             multimap_count(root, k, &metrics) == duplicates;
+    }
+    int height = multimap_height(root);
+    
+    start = nowSeconds();
+    for (int j = duplicates - 1; j >= 0; j--) { // remove-one takes the newest value each time
+        for (int k = 0; k < keys; k++) {
+            DuplicateChain* chain = multimap_get(root, k, &metrics);
+            ok = ok && chain != NULL && chain->head->value == k * duplicates + j;
+            root = multimap_remove_one(root, k, &metrics);
+            if (j > 0) {
+                ok = ok && multimap_count(root, k, &metrics) == j;
+            } else { // last duplicate: the key's node is deleted
+                ok = ok && multimap_get(root, k, &metrics) == NULL;
+            }
+        }
+    }
+    double removeTime = nowSeconds() - start;
+    ok = ok && root == NULL;
+    root = multimap_remove_one(root, 0, &metrics); // absent key is a no-op
+    multimap_free_all(root);
+    memtrack_end(&memory);
+    ok = ok && memory.allocations == memory.frees;
+    
+    long values = (long)keys * duplicates;
+    printHeader("MULTIMAP EXPERIMENT: DUPLICATE CHAINS");
+    printf("Keys: %d, values per key: %d, height: %d\n\n", keys, duplicates, height);
+    printf("Add:         %.0f values/s\n", values / addTime);
+    printf("Remove-one:  %.0f values/s\n", values / removeTime);
+    printf("Allocations: %ld, frees: %ld, peak %zu bytes\n", memory.allocations, memory.frees,
+           memory.peak_bytes);
+    printf("Chains, remove-one order, empty-key deletion: %s\n\n", ok ? "PASS" : "FAIL");
+}
+
+#if AVL_ORDER_STATS
+AVLNode* linearSelect(AVLNode* root, int* k) {
+    if (root == NULL) {
+        return NULL;
+    }
+    AVLNode* found = linearSelect(root->left, k);
+    if (found != NULL) {
+        return found;
+    }
+    if ((*k)-- == 0) {
+        return root;
+    }
+    return linearSelect(root->right, k);
+}
+
+// rank, select and count-in-range via subtree sizes vs in-order walks
+void runOrderStatsExperiment(int size, int queryCount) {
+    int* keys = (int*)malloc(size * sizeof(int));
+    
+    if (keys == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    
+    generateSortedData(keys, size);
+    shuffleArray(keys, size);
+    
+    AVLMetrics buildMetrics = {0};
+    AVLNode* root = NULL;
+    for (int i = 0; i < size; i++) {
+        root = avl_insert(root, keys[i], &buildMetrics);
+    }
+    
+    printHeader("ORDER STATISTICS: SUBTREE SIZES vs LINEAR WALK");
+    printf("Keys: %d, queries per operation: %d\n\n", size, queryCount);
+    
+    AVLMetrics rankMetrics = {0};
+    long checksum = 0;
+    long linearChecksum = 0;
+    
+    double start = nowSeconds();
+    for (int q = 0; q < queryCount; q++) {
+        checksum += avl_rank(root, keys[q % size], &rankMetrics);
+    }
+    double rankTime = nowSeconds() - start;
+    
+    start = nowSeconds();
+    for (int q = 0; q < queryCount; q++) {
+        int count = 0;
+        linearCountRange(root, 1, keys[q % size] - 1, &count);
+        linearChecksum += count;
+    }
+    double linearRankTime = nowSeconds() - start;
+    
+    printf("--- avl_rank ---\n");
+    printf("Indexed: %.1f ns/query, %.2f comparisons/query\n",
+           rankTime * 1e9 / queryCount, (double)rankMetrics.comparisons / queryCount);
+    printf("Linear:  %.1f ns/query (%s)\n\n", linearRankTime * 1e9 / queryCount,
+           checksum == linearChecksum ? "results match" : "RESULTS DIFFER");
+    
+    AVLMetrics selectMetrics = {0};
+    checksum = 0;
+    linearChecksum = 0;
+    
+    int missing = 0; // NULL selects, each one a mismatch
+    
+    start = nowSeconds();
+    for (int q = 0; q < queryCount; q++) {
+        AVLNode* node = avl_select(root, (int)(((long long)q * 7919) % size), &selectMetrics);
+        if (node == NULL) {
+            missing++;
+            continue;
+        }
+        checksum += node->data;
+    }
+    double selectTime = nowSeconds() - start;
+    
+    start = nowSeconds();
+    for (int q = 0; q < queryCount; q++) {
+        int k = (int)(((long long)q * 7919) % size);
+        AVLNode* node = linearSelect(root, &k);
+        if (node == NULL) {
+            missing++;
+            continue;
+        }
+        linearChecksum += node->data;
+    }
+    double linearSelectTime = nowSeconds() - start;
+    
+    printf("--- avl_select ---\n");
+    printf("Indexed: %.1f ns/query, %.2f comparisons/query\n",
+           selectTime * 1e9 / queryCount, (double)selectMetrics.comparisons / queryCount);
+    printf("Linear:  %.1f ns/query (%s)\n\n", linearSelectTime * 1e9 / queryCount,
+           checksum == linearChecksum && missing == 0 ? "results match" : "RESULTS DIFFER");
+    
+    AVLMetrics rangeMetrics = {0};
+    checksum = 0;
+    linearChecksum = 0;
+    
+    start = nowSeconds();
+    for (int q = 0; q < queryCount; q++) {
+        int lo = keys[q % size];
+        checksum += avl_count_range(root, lo, lo + size / 10, &rangeMetrics);
+    }
+    double rangeTime = nowSeconds() - start;
+    
+    start = nowSeconds();
+    for (int q = 0; q < queryCount; q++) {
+        int lo = keys[q % size];
+        int count = 0;
+        linearCountRange(root, lo, lo + size / 10, &count);
+        linearChecksum += count;
+    }
+    double linearRangeTime = nowSeconds() - start;
+    
+    printf("--- avl_count_range (10%% wide) ---\n");
+    printf("Indexed: %.1f ns/query, %.2f comparisons/query\n",
+           rangeTime * 1e9 / queryCount, (double)rangeMetrics.comparisons / queryCount);
+    printf("Linear:  %.1f ns/query (%s)\n\n", linearRangeTime * 1e9 / queryCount,
+           checksum == linearChecksum ? "results match" : "RESULTS DIFFER");
+    
+    freeAVL(root);
+    free(keys);
+}
+#endif
+
+int main(int argc, char* argv[]) {
+    srand(time(NULL));
+    
+    if (argc > 1 && strcmp(argv[1], "churn") == 0) { // experiment churn [size] [rounds]
+        int size = argc > 2 ? atoi(argv[2]) : 100000;
+        int rounds = argc > 3 ? atoi(argv[3]) : 20;
+        if (size < 10 || rounds < 1) { // a batch is a tenth of the live keys
+            printf("usage: experiment churn [size >= 10] [rounds >= 1]\n");
+            return 1;
+        }
+        runChurnExperiment(size, rounds);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "skewed") == 0) { // experiment skewed [size] [lookups]
+        int size = argc > 2 ? atoi(argv[2]) : 100000;
+        int queryCount = argc > 3 ? atoi(argv[3]) : 1000000;
+        if (size < 1 || queryCount < 1) { // the splay loop reads the root after every lookup
+            printf("usage: experiment skewed [size >= 1] [lookups >= 1]\n");
+            return 1;
+        }
+        runSkewedExperiment(size, queryCount);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "generic") == 0) { // experiment generic [size]
+        int size = argc > 2 ? atoi(argv[2]) : 1000000;
+        runGenericExperiment(size);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "overhead") == 0) { // experiment overhead [size] [rounds]
+        int size = argc > 2 ? atoi(argv[2]) : 200000;
+        int rounds = argc > 3 ? atoi(argv[3]) : 3;
+        runOverheadExperiment(size, rounds);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "startup") == 0) { // experiment startup [max size] [file]
+        int maxSize = argc > 2 ? atoi(argv[2]) : 10000000;
+        char* path = argc > 3 ? argv[3] : "avl_startup.bin";
+        runStartupExperiment(maxSize, path);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "image") == 0) { // experiment image [size] [lookups] [file]
+        int size = argc > 2 ? atoi(argv[2]) : 1000000;
+        int lookups = argc > 3 ? atoi(argv[3]) : 100000;
+        char* path = argc > 4 ? argv[4] : "avl_image.bin";
+        runImageExperiment(size, lookups, path);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "wal") == 0) { // experiment wal [ops] [dir] [checkpoint every]
+        int ops = argc > 2 ? atoi(argv[2]) : 20000;
+        char* dir = argc > 3 ? argv[3] : ".";
+        long checkpointEvery = argc > 4 ? atol(argv[4]) : ops / 4 + 1; // +1 so the log tail is not empty
+        runWALExperiment(ops, dir, checkpointEvery);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "matrix") == 0) { // experiment matrix [workers, 1 = serial] [max size] [seeds]
+        int workers = argc > 2 ? atoi(argv[2]) : matrix_cpus();
+        int maxSize = argc > 3 ? atoi(argv[3]) : 10000;
+        int seeds = argc > 4 ? atoi(argv[4]) : 3;
+        runMatrixExperiment(workers, maxSize, seeds);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "batch") == 0) { // experiment batch [size] [lookups]
+        int size = argc > 2 ? atoi(argv[2]) : 4000000;
+        int lookups = argc > 3 ? atoi(argv[3]) : 2000000;
+        runBatchLookupExperiment(size, lookups);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "layout") == 0) { // experiment layout [max size] [lookups]
+        int maxSize = argc > 2 ? atoi(argv[2]) : 2097152;
+        int lookups = argc > 3 ? atoi(argv[3]) : 1000000;
+        runLayoutExperiment(maxSize, lookups);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "hugepage") == 0) { // experiment hugepage [size] [lookups]
+        int size = argc > 2 ? atoi(argv[2]) : 4000000;
+        int lookups = argc > 3 ? atoi(argv[3]) : 2000000;
+        runHugePageExperiment(size, lookups);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "retrace") == 0) { // experiment retrace [size] [seed], csv on stdout
+        int size = argc > 2 ? atoi(argv[2]) : 100000;
+        unsigned int seed = argc > 3 ? (unsigned int)strtoul(argv[3], NULL, 10) : 1;
+        runRetraceExperiment(size, seed);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "intrusive") == 0) { // experiment intrusive [size] [rounds]
+        int size = argc > 2 ? atoi(argv[2]) : 1000000;
+        int rounds = argc > 3 ? atoi(argv[3]) : 3;
+        runIntrusiveExperiment(size, rounds);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "handles") == 0) { // experiment handles [size]
+        int size = argc > 2 ? atoi(argv[2]) : 1000000;
+        runHandleExperiment(size);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "compact") == 0) { // experiment compact [size] [rounds] [lookups]
+        int size = argc > 2 ? atoi(argv[2]) : 1000000;
+        int rounds = argc > 3 ? atoi(argv[3]) : 20;
+        int lookups = argc > 4 ? atoi(argv[4]) : 1000000;
+        runCompactionExperiment(size, rounds, lookups);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "multimap") == 0) { // experiment multimap [keys] [values per key]
+        int keys = argc > 2 ? atoi(argv[2]) : 100000;
+        int duplicates = argc > 3 ? atoi(argv[3]) : 8;
+        runMultimapExperiment(keys, duplicates);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "map") == 0) { // experiment map [size] [updates]
+        int size = argc > 2 ? atoi(argv[2]) : 100000;
+        int updateCount = argc > 3 ? atoi(argv[3]) : 1000000;
+        runMapExperiment(size, updateCount);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "dump") == 0) { // experiment dump [size]
+        int size = argc > 2 ? atoi(argv[2]) : 1000000;
+        runDumpExperiment(size);
+        return 0;
+    }
+    
+    if (argc > 1 && strcmp(argv[1], "range") == 0) { // experiment range [size] [scans]
+        int size = argc > 2 ? atoi(argv[2]) : 100000;
+        int scanCount = argc > 3 ? atoi(argv[3]) : 200;
+        runRangeScanExperiment(size, scanCount);
+        return 0;
+    }
+    
+#if AVL_ORDER_STATS
+    if (argc > 1 && strcmp(argv[1], "rank") == 0) { // experiment rank [size] [queries]
+        int size = argc > 2 ? atoi(argv[2]) : 100000;
+        int queryCount = argc > 3 ? atoi(argv[3]) : 1000;
+        runOrderStatsExperiment(size, queryCount);
+        return 0;
+    }
+#endif
+    
+    int sizes[] = {100, 1000, 5000};
+    int numSizes = 3;
+    
+    printf("\n");
+    printHeader("AVL vs BST PERFORMANCE EXPERIMENT");
+    printf("This experiment compares the performance of\n");
+    printf("balanced (AVL, Red-Black) and unbalanced (BST) trees\n");
+    printf("across different dataset scenarios.\n");
+    if (!TREE_METRICS) {
+        printf("Built with TREE_METRICS=0: comparison and rotation counts read 0.\n");
+    }
+    printf("\n");
     
     for (int s = 0; s < numSizes; s++) {
         int size = sizes[s];
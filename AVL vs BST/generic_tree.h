@@ -0,0 +1,301 @@
+#ifndef GENERIC_TREE_H
+#define GENERIC_TREE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bst.h"
+#include "avl.h"
+#include "memtrack.h"
+
+// Type-generic BST and AVL trees, stamped out per key/value type by macro so
+// the comparison is inlined at compile time (no function pointers). LESS(a, b)
+// must be a strict ordering on KeyType and EQUAL(a, b) its equivalence, e.g.
+// GENERIC_LESS/GENERIC_EQUAL or GENERIC_STRING_LESS/GENERIC_STRING_EQUAL.
+// Searches test EQUAL first, the same shape as avl_search, which lets the
+// compiler pick the child without a branch.
+//
+//   DEFINE_GENERIC_AVL(Int64AVLNode, avl64, long long, double, GENERIC_LESS, GENERIC_EQUAL)
+//
+// declares the node type Int64AVLNode and avl64_create, avl64_insert,
+// avl64_search, avl64_delete, avl64_height and avl64_free. The AVL version
+// also gets the map operations avl64_get, avl64_upsert and avl64_get_or_insert.
+// Keys and values are stored by value; string keys are not copied, the caller
+// keeps them alive.
+
+#define GENERIC_LESS(a, b) ((a) < (b))
+#define GENERIC_EQUAL(a, b) ((a) == (b))
+#define GENERIC_STRING_LESS(a, b) (strcmp((a), (b)) < 0)
+#define GENERIC_STRING_EQUAL(a, b) (strcmp((a), (b)) == 0)
+
+#define DEFINE_GENERIC_BST(Node, prefix, KeyType, ValueType, LESS, EQUAL)           \
+                                                                                    \
+typedef struct Node {                                                               \
+    KeyType key;                                                                    \
+    ValueType value;                                                                \
+    struct Node *left;                                                              \
+    struct Node *right;                                                             \
+} Node;                                                                             \
+                                                                                    \
+static inline Node* prefix##_create(KeyType key, ValueType value) {                 \
+    Node* newNode = (Node*)tracked_malloc(sizeof(Node));                            \
+    if (newNode == NULL) {                                                          \
+        printf("Memory allocation failed!\n");                                      \
+        exit(1);                                                                    \
+    }                                                                               \
+    newNode->key = key;                                                             \
+    newNode->value = value;                                                         \
+    newNode->left = NULL;                                                           \
+    newNode->right = NULL;                                                          \
+    return newNode;                                                                 \
+}                                                                                   \
+                                                                                    \
+static inline Node* prefix##_insert(Node* root, KeyType key, ValueType value,       \
+                                    Metrics* metrics) {                             \
+    if (root == NULL) {                                                             \
+        return prefix##_create(key, value);                                         \
+    }                                                                               \
+    METRIC_INC(metrics, comparisons);                                               \
+    if (LESS(key, root->key)) {                                                     \
+        root->left = prefix##_insert(root->left, key, value, metrics);              \
+    } else if (LESS(root->key, key)) {                                              \
+        root->right = prefix##_insert(root->right, key, value, metrics);            \
+    }                                                                               \
+    return root;                                                                    \
+}                                                                                   \
+                                                                                    \
+static inline Node* prefix##_search(Node* root, KeyType key, Metrics* metrics) {    \
+    while (root != NULL) {                                                          \
+        METRIC_INC(metrics, comparisons);                                           \
+        if (EQUAL(key, root->key)) {                                                \
+            return root;                                                            \
+        }                                                                           \
+        root = LESS(key, root->key) ? root->left : root->right;                     \
+    }                                                                               \
+    return NULL;                                                                    \
+}                                                                                   \
+                                                                                    \
+static inline Node* prefix##_delete(Node* root, KeyType key, Metrics* metrics) {    \
+    if (root == NULL) {                                                             \
+        return NULL;                                                                \
+    }                                                                               \
+    METRIC_INC(metrics, comparisons);                                               \
+    if (LESS(key, root->key)) {                                                     \
+        root->left = prefix##_delete(root->left, key, metrics);                     \
+    } else if (LESS(root->key, key)) {                                              \
+        root->right = prefix##_delete(root->right, key, metrics);                   \
+    } else {                                                                        \
+        if (root->left == NULL || root->right == NULL) {                            \
+            Node* child = root->left ? root->left : root->right;                    \
+            tracked_free(root);                                                     \
+            return child;                                                           \
+        }                                                                           \
+        Node* temp = root->right;                                                   \
+        while (temp->left != NULL) {                                                \
+            temp = temp->left;                                                      \
+        }                                                                           \
+        root->key = temp->key;                                                      \
+        root->value = temp->value;                                                  \
+        root->right = prefix##_delete(root->right, temp->key, metrics);             \
+    }                                                                               \
+    return root;                                                                    \
+}                                                                                   \
+                                                                                    \
+static inline int prefix##_height(Node* root) {                                     \
+    if (root == NULL) {                                                             \
+        return 0;                                                                   \
+    }                                                                               \
+    int leftHeight = prefix##_height(root->left);                                   \
+    int rightHeight = prefix##_height(root->right);                                 \
+    return (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;               \
+}                                                                                   \
+                                                                                    \
+static inline void prefix##_free(Node* root) {                                      \
+    if (root != NULL) {                                                             \
+        prefix##_free(root->left);                                                  \
+        prefix##_free(root->right);                                                 \
+        tracked_free(root);                                                         \
+    }                                                                               \
+}
+
+#define DEFINE_GENERIC_AVL(Node, prefix, KeyType, ValueType, LESS, EQUAL)           \
+                                                                                    \
+typedef struct Node {                                                               \
+    KeyType key;                                                                    \
+    ValueType value;                                                                \
+    int height;                                                                     \
+    struct Node *left;                                                              \
+    struct Node *right;                                                             \
+} Node;                                                                             \
+                                                                                    \
+static inline Node* prefix##_create(KeyType key, ValueType value) {                 \
+    Node* newNode = (Node*)tracked_malloc(sizeof(Node));                            \
+    if (newNode == NULL) {                                                          \
+        printf("Memory allocation failed!\n");                                      \
+        exit(1);                                                                    \
+    }                                                                               \
+    newNode->key = key;                                                             \
+    newNode->value = value;                                                         \
+    newNode->height = 1;                                                            \
+    newNode->left = NULL;                                                           \
+    newNode->right = NULL;                                                          \
+    return newNode;                                                                 \
+}                                                                                   \
+                                                                                    \
+static inline int prefix##_height(Node* node) {                                     \
+    return node == NULL ? 0 : node->height;                                         \
+}                                                                                   \
+                                                                                    \
+static inline void prefix##_update(Node* node) {                                    \
+    int leftHeight = prefix##_height(node->left);                                   \
+    int rightHeight = prefix##_height(node->right);                                 \
+    node->height = (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;       \
+}                                                                                   \
+                                                                                    \
+static inline Node* prefix##_rotate_right(Node* y, AVLMetrics* metrics) {           \
+    Node* x = y->left;                                                              \
+    y->left = x->right;                                                             \
+    x->right = y;                                                                   \
+    prefix##_update(y);                                                             \
+    prefix##_update(x);                                                             \
+    METRIC_INC(metrics, rotations);                                                 \
+    return x;                                                                       \
+}                                                                                   \
+                                                                                    \
+static inline Node* prefix##_rotate_left(Node* x, AVLMetrics* metrics) {            \
+    Node* y = x->right;                                                             \
+    x->right = y->left;                                                             \
+    y->left = x;                                                                    \
+    prefix##_update(x);                                                             \
+    prefix##_update(y);                                                             \
+    METRIC_INC(metrics, rotations);                                                 \
+    return y;                                                                       \
+}                                                                                   \
+                                                                                    \
+static inline Node* prefix##_rebalance(Node* root, AVLMetrics* metrics) {           \
+    prefix##_update(root);                                                          \
+    int balance = prefix##_height(root->left) - prefix##_height(root->right);       \
+    if (balance > 1) {                                                              \
+        if (prefix##_height(root->left->left) < prefix##_height(root->left->right)) { \
+            root->left = prefix##_rotate_left(root->left, metrics);                 \
+        }                                                                           \
+        return prefix##_rotate_right(root, metrics);                                \
+    }                                                                               \
+    if (balance < -1) {                                                             \
+        if (prefix##_height(root->right->right) < prefix##_height(root->right->left)) { \
+            root->right = prefix##_rotate_right(root->right, metrics);              \
+        }                                                                           \
+        return prefix##_rotate_left(root, metrics);                                 \
+    }                                                                               \
+    return root;                                                                    \
+}                                                                                   \
+                                                                                    \
+static inline Node* prefix##_insert(Node* root, KeyType key, ValueType value,       \
+                                    AVLMetrics* metrics) {                          \
+    if (root == NULL) {                                                             \
+        return prefix##_create(key, value);                                         \
+    }                                                                               \
+    METRIC_INC(metrics, comparisons);                                               \
+    if (LESS(key, root->key)) {                                                     \
+        root->left = prefix##_insert(root->left, key, value, metrics);              \
+    } else if (LESS(root->key, key)) {                                              \
+        root->right = prefix##_insert(root->right, key, value, metrics);            \
+    } else {                                                                        \
+        return root;                                                                \
+    }                                                                               \
+    return prefix##_rebalance(root, metrics);                                       \
+}                                                                                   \
+                                                                                    \
+static inline Node* prefix##_search(Node* root, KeyType key, AVLMetrics* metrics) { \
+    while (root != NULL) {                                                          \
+        METRIC_INC(metrics, comparisons);                                           \
+        if (EQUAL(key, root->key)) {                                                \
+            return root;                                                            \
+        }                                                                           \
+        root = LESS(key, root->key) ? root->left : root->right;                     \
+    }                                                                               \
+    return NULL;                                                                    \
+}                                                                                   \
+                                                                                    \
+/* single descent: points *slot at the value stored for key, inserting              \
+   (key, value) first when key is missing. levels whose child kept its              \
+   height skip rebalancing, so updating an existing key writes nothing but          \
+   the value. the slot stays valid until the next delete, which may move a          \
+   successor's key and value */                                                     \
+static inline Node* prefix##_get_or_insert(Node* root, KeyType key,                 \
+                                           ValueType value, ValueType** slot,       \
+                                           AVLMetrics* metrics) {                   \
+    if (root == NULL) {                                                             \
+        Node* newNode = prefix##_create(key, value);                                \
+        *slot = &newNode->value;                                                    \
+        return newNode;                                                             \
+    }                                                                               \
+    METRIC_INC(metrics, comparisons);                                               \
+    if (LESS(key, root->key)) {                                                     \
+        int before = prefix##_height(root->left);                                   \
+        root->left = prefix##_get_or_insert(root->left, key, value, slot, metrics); \
+        if (prefix##_height(root->left) == before) {                                \
+            return root;                                                            \
+        }                                                                           \
+    } else if (LESS(root->key, key)) {                                              \
+        int before = prefix##_height(root->right);                                  \
+        root->right = prefix##_get_or_insert(root->right, key, value, slot,         \
+                                             metrics);                              \
+        if (prefix##_height(root->right) == before) {                               \
+            return root;                                                            \
+        }                                                                           \
+    } else {                                                                        \
+        *slot = &root->value;                                                       \
+        return root;                                                                \
+    }                                                                               \
+    return prefix##_rebalance(root, metrics);                                       \
+}                                                                                   \
+                                                                                    \
+static inline Node* prefix##_upsert(Node* root, KeyType key, ValueType value,       \
+                                    AVLMetrics* metrics) {                          \
+    ValueType* slot;                                                                \
+    root = prefix##_get_or_insert(root, key, value, &slot, metrics);                \
+    *slot = value;                                                                  \
+    return root;                                                                    \
+}                                                                                   \
+                                                                                    \
+static inline ValueType* prefix##_get(Node* root, KeyType key, AVLMetrics* metrics) { \
+    Node* node = prefix##_search(root, key, metrics);                               \
+    return node == NULL ? NULL : &node->value;                                      \
+}                                                                                   \
+                                                                                    \
+static inline Node* prefix##_delete(Node* root, KeyType key, AVLMetrics* metrics) { \
+    if (root == NULL) {                                                             \
+        return NULL;                                                                \
+    }                                                                               \
+    METRIC_INC(metrics, comparisons);                                               \
+    if (LESS(key, root->key)) {                                                     \
+        root->left = prefix##_delete(root->left, key, metrics);                     \
+    } else if (LESS(root->key, key)) {                                              \
+        root->right = prefix##_delete(root->right, key, metrics);                   \
+    } else {                                                                        \
+        if (root->left == NULL || root->right == NULL) {                            \
+            Node* child = root->left ? root->left : root->right;                    \
+            tracked_free(root);                                                     \
+            return child;                                                           \
+        }                                                                           \
+        Node* temp = root->right;                                                   \
+        while (temp->left != NULL) {                                                \
+            temp = temp->left;                                                      \
+        }                                                                           \
+        root->key = temp->key;                                                      \
+        root->value = temp->value;                                                  \
+        root->right = prefix##_delete(root->right, temp->key, metrics);             \
+    }                                                                               \
+    return prefix##_rebalance(root, metrics);                                       \
+}                                                                                   \
+                                                                                    \
+static inline void prefix##_free(Node* root) {                                      \
+    if (root != NULL) {                                                             \
+        prefix##_free(root->left);                                                  \
+        prefix##_free(root->right);                                                 \
+        tracked_free(root);                                                         \
+    }                                                                               \
+}
+
+#endif
@@ -0,0 +1,155 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "layout.h"
+
+#define EYTZINGER_ALIGN 64 // cache line
+
+#if defined(__GNUC__)
+#define LAYOUT_PREFETCH(p) __builtin_prefetch(p)
+#else
+#define LAYOUT_PREFETCH(p) ((void)(p))
+#endif
+
+int avl_inorder_keys(AVLNode* root, int* keys, int capacity) {
+    AVLCursor cursor;
+    int count = 0;
+    for (avl_cursor_first(&cursor, root); avl_cursor_valid(&cursor) && count < capacity;
+         avl_cursor_next(&cursor)) {
+        keys[count++] = avl_cursor_node(&cursor)->data;
+    }
+    return count;
+}
+
+// in-order walk of the implicit complete tree hands out the sorted keys
+static int fillEytzinger(int* keys, int n, const int* sorted, int next, int index) {
+    if (index <= n) {
+        next = fillEytzinger(keys, n, sorted, next, 2 * index);
+        keys[index] = sorted[next++];
+        next = fillEytzinger(keys, n, sorted, next, 2 * index + 1);
+    }
+    return next;
+}
+
+EytzingerArray* eytzinger_build(const int* sorted, int n) {
+    EytzingerArray* array = (EytzingerArray*)malloc(sizeof(EytzingerArray));
+    size_t bytes = ((n + 1) * sizeof(int) + EYTZINGER_ALIGN - 1) / EYTZINGER_ALIGN * EYTZINGER_ALIGN;
+    int* keys = (int*)aligned_alloc(EYTZINGER_ALIGN, bytes); // keys[16i..16i+15] is then one cache line
+    if (array == NULL || keys == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    keys[0] = 0;
+    fillEytzinger(keys, n, sorted, 0, 1);
+    array->keys = keys;
+    array->n = n;
+    return array;
+}
+
+// Branch-free descent to the lower bound (Khuong and Morin): the loop always
+// runs to a leaf, then the trailing right turns are undone. The prefetch pulls
+// in the line holding the 16 descendants four levels down, keys[16i..16i+15],
+// which the 64-byte aligned array keeps within one line; prefetching past the
+// end is harmless.
+int eytzinger_search(const EytzingerArray* array, int data, AVLMetrics* metrics) {
+    const int* keys = array->keys;
+    int n = array->n;
+    unsigned int i = 1;
+
+    while (i <= (unsigned int)n) {
+        LAYOUT_PREFETCH(keys + 16 * i);
+        METRIC_INC(metrics, comparisons);
+        i = 2 * i + (keys[i] < data);
+    }
+    while (i & 1) { // strip the right turns taken below the lower bound
+        i >>= 1;
+    }
+    i >>= 1;
+
+    return i != 0 && keys[i] == data ? (int)i : 0;
+}
+
+void freeEytzinger(EytzingerArray* array) {
+    free(array->keys);
+    free(array);
+}
+
+// Writes the breadth-first indices of the subtree of the given height under
+// root to order[] in vEB order, skipping indices past n (the complete tree's
+// missing last-level nodes). Returns the next free slot.
+static int vebOrder(int* order, int next, long root, int height, int n) {
+    if (root > n) {
+        return next;
+    }
+    if (height == 1) {
+        order[next++] = (int)root;
+        return next;
+    }
+
+    int topHeight = height / 2;
+    int bottomHeight = height - topHeight;
+    next = vebOrder(order, next, root, topHeight, n);
+
+    long first = root << topHeight; // leftmost node just below the top tree
+    for (long child = first; child < first + (1L << topHeight); child++) {
+        next = vebOrder(order, next, child, bottomHeight, n);
+    }
+    return next;
+}
+
+VEBTree* veb_build(const int* sorted, int n) {
+    VEBTree* tree = (VEBTree*)malloc(sizeof(VEBTree));
+    VEBNode* nodes = (VEBNode*)malloc((n > 0 ? n : 1) * sizeof(VEBNode));
+    int* order = (int*)malloc((n > 0 ? n : 1) * sizeof(int));
+    int* position = (int*)malloc((n + 1) * sizeof(int)); // breadth-first index -> slot
+    if (tree == NULL || nodes == NULL || order == NULL || position == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+
+    EytzingerArray* shape = eytzinger_build(sorted, n); // keys by breadth-first index
+
+    int height = 0;
+    while ((1L << height) - 1 < n) {
+        height++;
+    }
+    if (n > 0) {
+        vebOrder(order, 0, 1, height, n);
+    }
+    for (int slot = 0; slot < n; slot++) {
+        position[order[slot]] = slot;
+    }
+
+    for (int slot = 0; slot < n; slot++) {
+        long index = order[slot];
+        nodes[slot].data = shape->keys[index];
+        nodes[slot].left = 2 * index <= n ? position[2 * index] : -1;
+        nodes[slot].right = 2 * index + 1 <= n ? position[2 * index + 1] : -1;
+    }
+
+    freeEytzinger(shape);
+    free(position);
+    free(order);
+    tree->nodes = nodes;
+    tree->n = n;
+    return tree;
+}
+
+const VEBNode* veb_search(const VEBTree* tree, int data, AVLMetrics* metrics) {
+    int index = tree->n > 0 ? 0 : -1;
+
+    while (index >= 0) {
+        const VEBNode* node = &tree->nodes[index];
+        METRIC_INC(metrics, comparisons);
+
+        if (data == node->data) {
+            return node;
+        }
+        index = data < node->data ? node->left : node->right;
+    }
+    return NULL;
+}
+
+void freeVEB(VEBTree* tree) {
+    free(tree->nodes);
+    free(tree);
+}
@@ -0,0 +1,43 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "avl.h"
+
+// Static, read-only layouts of a sorted key set for the lookup-only phase.
+//
+// Eytzinger: the keys of a complete binary search tree in breadth-first order,
+// 1-based, children of i at 2i and 2i + 1. No pointers, 4 bytes per key.
+//
+// van Emde Boas: the same complete tree with nodes stored in vEB order: the
+// top half of the levels first, then each bottom subtree contiguously, applied
+// recursively. Any root-to-leaf path then touches O(log_B n) blocks for every
+// block size B at once, so the layout needs no tuning to a cache level.
+// Children are explicit indices.
+
+typedef struct {
+    int* keys; // keys[1..n], keys[0] unused
+    int n;
+} EytzingerArray;
+
+typedef struct { // 12 bytes
+    int data;
+    int left; // index into nodes, -1 for none
+    int right;
+} VEBNode;
+
+typedef struct {
+    VEBNode* nodes; // root at 0
+    int n;
+} VEBTree;
+
+int avl_inorder_keys(AVLNode* root, int* keys, int capacity); // ascending, returns keys written
+
+EytzingerArray* eytzinger_build(const int* sorted, int n); // strictly ascending keys
+int eytzinger_search(const EytzingerArray* array, int data, AVLMetrics* metrics); // position, 0 if absent
+void freeEytzinger(EytzingerArray* array);
+
+VEBTree* veb_build(const int* sorted, int n); // strictly ascending keys
+const VEBNode* veb_search(const VEBTree* tree, int data, AVLMetrics* metrics);
+void freeVEB(VEBTree* tree);
+
+#endif
@@ -0,0 +1,202 @@
+#define _GNU_SOURCE // cpu affinity, sched_getcpu
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "matrix.h"
+#include "memtrack.h"
+
+#define MATRIX_STACK_SIZE (64 << 20) // degenerate BSTs recurse once per key
+
+typedef struct { // shared by the pool
+    MatrixCell* cells;
+    int count;
+    atomic_int next;
+} MatrixQueue;
+
+typedef struct {
+    MatrixQueue* queue;
+    int cpu; // -1 to leave unpinned
+} MatrixWorker;
+
+static double matrixNow(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int allowedCpus(int cpus[], int capacity) {
+    cpu_set_t set;
+    int count = 0;
+
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return 0;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE && count < capacity; cpu++) {
+        if (CPU_ISSET(cpu, &set)) {
+            cpus[count++] = cpu;
+        }
+    }
+    return count;
+}
+
+int matrix_cpus(void) {
+    int cpus[CPU_SETSIZE];
+    int count = allowedCpus(cpus, CPU_SETSIZE);
+    return count > 0 ? count : 1;
+}
+
+static void pinToCpu(int cpu) { // best effort, the run still works unpinned
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+}
+
+static void runCell(MatrixCell* cell) {
+    const OrderedSetOps* ops = ordered_set_get(cell->set);
+    int* keys = (int*)malloc(cell->size * sizeof(int)); // first touched here, on this worker's node
+
+    if (keys == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+
+    generateSeededData(keys, cell->size, cell->dataset, cell->seed);
+    memset(&cell->metrics, 0, sizeof(TreeMetrics));
+    cell->cpu = sched_getcpu();
+
+    MemStats memory; // memtrack charges per thread, so cells don't mix
+    memtrack_begin(&memory);
+    double start = matrixNow();
+    void* set = ops->create();
+    for (int i = 0; i < cell->size; i++) {
+        ops->insert(set, keys[i], &cell->metrics);
+    }
+    cell->metrics.time_taken = matrixNow() - start;
+    memtrack_end(&memory);
+    cell->live_bytes = memory.live_bytes;
+    cell->metrics.final_height = ops->height(set);
+
+    TreeMetrics searchMetrics = {0};
+    start = matrixNow();
+    for (int i = 0; i < cell->size; i++) {
+        ops->contains(set, keys[i], &searchMetrics);
+    }
+    cell->search_time = matrixNow() - start;
+    cell->search_comparisons = searchMetrics.comparisons;
+
+    ops->destroy(set);
+    free(keys);
+}
+
+static void* matrixWorker(void* arg) {
+    MatrixWorker* worker = (MatrixWorker*)arg;
+    MatrixQueue* queue = worker->queue;
+
+    pinToCpu(worker->cpu);
+    for (int i = atomic_fetch_add(&queue->next, 1); i < queue->count;
+         i = atomic_fetch_add(&queue->next, 1)) {
+        runCell(&queue->cells[i]);
+    }
+    return NULL;
+}
+
+int matrix_run(MatrixCell* cells, int count, int workers) {
+    int cpus[CPU_SETSIZE];
+    int cpuCount = allowedCpus(cpus, CPU_SETSIZE);
+
+    if (workers > cpuCount && cpuCount > 0) { // one worker per core, never share
+        workers = cpuCount;
+    }
+    if (workers < 1) {
+        workers = 1;
+    }
+
+    MatrixQueue queue;
+    queue.cells = cells;
+    queue.count = count;
+    atomic_init(&queue.next, 0);
+
+    MatrixWorker* pool = (MatrixWorker*)malloc(workers * sizeof(MatrixWorker));
+    pthread_t* threads = (pthread_t*)malloc(workers * sizeof(pthread_t));
+    if (pool == NULL || threads == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    for (int w = 0; w < workers; w++) {
+        pool[w].queue = &queue;
+        pool[w].cpu = cpuCount > 0 ? cpus[w] : -1;
+    }
+
+    pthread_attr_t attr; // workers == 1 is strict serial mode, still on a pool thread
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, MATRIX_STACK_SIZE);
+    for (int w = 0; w < workers; w++) {
+        if (pthread_create(&threads[w], &attr, matrixWorker, &pool[w]) != 0) {
+            printf("Thread creation failed!\n");
+            exit(1);
+        }
+    }
+    for (int w = 0; w < workers; w++) {
+        pthread_join(threads[w], NULL);
+    }
+    pthread_attr_destroy(&attr);
+
+    free(threads);
+    free(pool);
+    return workers;
+}
+
+void matrix_print_csv(MatrixCell* cells, int count) {
+    printf("structure,dataset,size,seed,cpu,height,comparisons,rotations,rebuilds,"
+           "insert_s,search_ns_per_key,search_comparisons,live_bytes,"
+           "ll_rotations,rr_rotations,lr_rotations,rl_rotations,retrace_ops,retrace_steps\n");
+    for (int i = 0; i < count; i++) {
+        MatrixCell* cell = &cells[i];
+        printf("%s,%s,%d,%u,%d,%d,%ld,%ld,%ld,%.6f,%.1f,%ld,%zu,%ld,%ld,%ld,%ld,%ld,%ld\n",
+               ordered_set_get(cell->set)->name, datasetTypeName(cell->dataset), cell->size,
+               cell->seed, cell->cpu, cell->metrics.final_height, cell->metrics.comparisons,
+               cell->metrics.rotations, cell->metrics.rebuilds, cell->metrics.time_taken,
+               cell->size > 0 ? cell->search_time * 1e9 / cell->size : 0.0,
+               cell->search_comparisons, cell->live_bytes, cell->metrics.ll_rotations,
+               cell->metrics.rr_rotations, cell->metrics.lr_rotations, cell->metrics.rl_rotations,
+               cell->metrics.retrace_ops, cell->metrics.retrace_steps);
+    }
+}
+
+// cells of one (structure, dataset, size) differ only in seed; average them
+void matrix_print_summary(MatrixCell* cells, int count) {
+    printf("%-10s %-28s %9s %6s %8s %12s %12s\n", "Structure", "Dataset", "Size", "Seeds",
+           "Height", "Insert s", "Search ns");
+    for (int i = 0; i < count; i++) {
+        int first = 1; // report each group at its first cell
+        for (int j = 0; j < i && first; j++) {
+            first = !(cells[j].set == cells[i].set && cells[j].dataset == cells[i].dataset &&
+                      cells[j].size == cells[i].size);
+        }
+        if (!first) {
+            continue;
+        }
+
+        int seeds = 0;
+        double height = 0.0, insertTime = 0.0, searchNs = 0.0;
+        for (int j = i; j < count; j++) {
+            if (cells[j].set == cells[i].set && cells[j].dataset == cells[i].dataset &&
+                cells[j].size == cells[i].size) {
+                seeds++;
+                height += cells[j].metrics.final_height;
+                insertTime += cells[j].metrics.time_taken;
+                searchNs += cells[j].size > 0 ? cells[j].search_time * 1e9 / cells[j].size : 0.0;
+            }
+        }
+        printf("%-10s %-28s %9d %6d %8.1f %12.6f %12.1f\n", ordered_set_get(cells[i].set)->name,
+               datasetTypeName(cells[i].dataset), cells[i].size, seeds, height / seeds,
+               insertTime / seeds, searchNs / seeds);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <stddef.h>
+#include "dataset.h"
+#include "orderedset.h"
+
+// Benchmark matrix executor. Each cell is one (structure, dataset, size,
+// seed) run: generate the dataset from the seed, insert every key, look every
+// key up, tear down. Cells are independent, so a pool of worker threads takes
+// them in turn; each worker is pinned to its own CPU and generates its data
+// after pinning, so first-touch placement keeps the pages on that CPU's NUMA
+// node. With one worker the cells run strictly one at a time on a single
+// pinned thread, for latency numbers without neighbours; it gets the same
+// large stack as the pool, so deep recursive builds behave the same in both.
+
+typedef struct {
+    int set;            // ordered set registry index
+    DatasetType dataset;
+    int size;
+    unsigned int seed;
+    // results, filled by the worker
+    TreeMetrics metrics; // comparisons and rotations of the build
+    long search_comparisons;
+    double search_time;
+    size_t live_bytes;
+    int cpu;            // where it ran, -1 if unknown
+} MatrixCell;
+
+int matrix_cpus(void); // cpus this process may run on
+int matrix_run(MatrixCell* cells, int count, int workers); // returns workers used
+void matrix_print_csv(MatrixCell* cells, int count); // one row per cell
+void matrix_print_summary(MatrixCell* cells, int count); // means over seeds
+
+#endif
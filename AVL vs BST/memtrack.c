@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <malloc.h>
+#include "memtrack.h"
+
+// glibc keeps one size_t of chunk header in front of every allocation,
+// on top of whatever slack malloc_usable_size reports
+#define MEMTRACK_CHUNK_HEADER sizeof(size_t)
+
+static _Thread_local MemStats* currentStats = NULL; // per thread so parallel runs don't mix
+
+void* tracked_malloc(size_t size) {
+    void* ptr = malloc(size);
+    MemStats* stats = currentStats;
+
+    if (ptr != NULL && stats != NULL) {
+        size_t usable = malloc_usable_size(ptr);
+        stats->allocations++;
+        stats->bytes_requested += size;
+        stats->bytes_usable += usable;
+        stats->live_bytes += usable;
+        if (stats->live_bytes > stats->peak_bytes) {
+            stats->peak_bytes = stats->live_bytes;
+        }
+    }
+    return ptr;
+}
+
+void tracked_free(void* ptr) {
+    MemStats* stats = currentStats;
+
+    if (ptr != NULL && stats != NULL) {
+        size_t usable = malloc_usable_size(ptr);
+        stats->frees++;
+        stats->live_bytes -= usable < stats->live_bytes ? usable : stats->live_bytes;
+    }
+    free(ptr);
+}
+
+void memtrack_begin(MemStats* stats) {
+    long peakKb;
+    memset(stats, 0, sizeof(MemStats));
+    memtrack_read_rss(&stats->rss_start_kb, &peakKb);
+    currentStats = stats;
+}
+
+void memtrack_end(MemStats* stats) {
+    long rssKb, peakKb;
+    currentStats = NULL;
+    if (memtrack_read_rss(&rssKb, &peakKb) && stats->rss_start_kb >= 0) {
+        stats->rss_growth_kb = rssKb - stats->rss_start_kb;
+    }
+}
+
+size_t memtrack_overhead(MemStats* stats) { // slack inside chunks plus chunk headers
+    return stats->bytes_usable - stats->bytes_requested + stats->allocations * MEMTRACK_CHUNK_HEADER;
+}
+
+int memtrack_read_rss(long* rssKb, long* peakKb) {
+    *rssKb = -1;
+    *peakKb = -1;
+
+    FILE* file = fopen("/proc/self/status", "r");
+    if (file == NULL) {
+        return 0;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (strncmp(line, "VmRSS:", 6) == 0) {
+            *rssKb = strtol(line + 6, NULL, 10);
+        } else if (strncmp(line, "VmHWM:", 6) == 0) {
+            *peakKb = strtol(line + 6, NULL, 10);
+        }
+    }
+    fclose(file);
+
+    return *rssKb >= 0 && *peakKb >= 0;
+}
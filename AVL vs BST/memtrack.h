@@ -0,0 +1,35 @@
+#ifndef MEMTRACK_H
+#define MEMTRACK_H
+
+#include <stddef.h>
+
+// Allocation accounting for the tree nodes. Every tree allocates its nodes
+// through tracked_malloc/tracked_free; while memtrack_begin(&stats) is active
+// on a thread, those calls are charged to stats, otherwise they are plain
+// malloc/free. Frees are only charged to the stats that are active at the time
+// of the free, so build and tear down a structure under the same stats.
+
+typedef struct { // one structure's allocator footprint
+    long allocations;
+    long frees;
+    size_t bytes_requested; // sum of sizes asked for
+    size_t bytes_usable;    // sum of malloc_usable_size, i.e. what malloc handed out
+    size_t live_bytes;      // usable bytes still allocated
+    size_t peak_bytes;      // highest live_bytes seen
+    long rss_growth_kb;     // VmRSS after memtrack_end minus VmRSS at memtrack_begin
+    long rss_start_kb;
+} MemStats;
+
+void* tracked_malloc(size_t size);
+void tracked_free(void* ptr);
+
+void memtrack_begin(MemStats* stats); // zeroes stats and charges this thread's allocations to it
+void memtrack_end(MemStats* stats);   // stops charging and records rss growth
+
+size_t memtrack_overhead(MemStats* stats); // estimated allocator bytes beyond what was requested
+
+// VmRSS and VmHWM of this process from /proc/self/status, in kB.
+// Returns 0 and leaves both at -1 where /proc is not available.
+int memtrack_read_rss(long* rssKb, long* peakKb);
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+// Instrumentation counters (comparisons, rotations, ...) are compiled in by
+// default. Build with -DTREE_METRICS=0 to compile every counter update out;
+// the metrics arguments stay in the API but are never written.
+
+#ifndef TREE_METRICS
+#define TREE_METRICS 1
+#endif
+
+#define METRIC_ADD_ENABLED(metrics, field, n) ((metrics)->field += (n))
+#define METRIC_ADD_DISABLED(metrics, field, n) ((void)(metrics), (void)(n))
+
+#if TREE_METRICS
+#define METRIC_ADD_DEFAULT METRIC_ADD_ENABLED
+#else
+#define METRIC_ADD_DEFAULT METRIC_ADD_DISABLED
+#endif
+
+// generic_tree.h instantiations pick up whatever METRIC_ADD means at the point
+// of DEFINE_GENERIC_*, so one source can be stamped out both ways
+#define METRIC_ADD METRIC_ADD_DEFAULT
+#define METRIC_INC(metrics, field) METRIC_ADD(metrics, field, 1)
+
+#endif
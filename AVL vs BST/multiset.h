@@ -0,0 +1,95 @@
+#ifndef MULTISET_H
+#define MULTISET_H
+
+#include "generic_tree.h"
+
+// Duplicate-preserving AVL trees. AVLMultisetNode keeps one node per distinct
+// key with an occurrence count; AVLMultimapNode additionally chains every
+// value inserted under the key, newest first.
+
+typedef struct DuplicateEntry { // one value of a repeated key
+    int value;
+    struct DuplicateEntry* next;
+} DuplicateEntry;
+
+typedef struct { // all values stored under one key
+    int count;
+    DuplicateEntry* head;
+} DuplicateChain;
+
+DEFINE_GENERIC_AVL(AVLMultisetNode, multiset, int, int, GENERIC_LESS, GENERIC_EQUAL)
+DEFINE_GENERIC_AVL(AVLMultimapNode, multimap, int, DuplicateChain, GENERIC_LESS, GENERIC_EQUAL)
+
+static inline AVLMultisetNode* multiset_add(AVLMultisetNode* root, int key, AVLMetrics* metrics) {
+    int* count;
+    root = multiset_get_or_insert(root, key, 0, &count, metrics);
+    (*count)++;
+    return root;
+}
+
+static inline int multiset_count(AVLMultisetNode* root, int key, AVLMetrics* metrics) {
+    int* count = multiset_get(root, key, metrics);
+    return count == NULL ? 0 : *count;
+}
+
+// drop one occurrence, the node goes away with the last one
+static inline AVLMultisetNode* multiset_remove_one(AVLMultisetNode* root, int key, AVLMetrics* metrics) {
+    int* count = multiset_get(root, key, metrics);
+    if (count != NULL && --(*count) == 0) {
+        root = multiset_delete(root, key, metrics);
+    }
+    return root;
+}
+
+static inline AVLMultimapNode* multimap_add(AVLMultimapNode* root, int key, int value, AVLMetrics* metrics) {
+    DuplicateChain empty = {0, NULL};
+    DuplicateChain* chain;
+    root = multimap_get_or_insert(root, key, empty, &chain, metrics);
+
+    DuplicateEntry* entry = (DuplicateEntry*)tracked_malloc(sizeof(DuplicateEntry));
+    if (entry == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    entry->value = value;
+    entry->next = chain->head;
+    chain->head = entry;
+    chain->count++;
+    return root;
+}
+
+static inline int multimap_count(AVLMultimapNode* root, int key, AVLMetrics* metrics) {
+    DuplicateChain* chain = multimap_get(root, key, metrics);
+    return chain == NULL ? 0 : chain->count;
+}
+
+// drop the newest value stored under key
+static inline AVLMultimapNode* multimap_remove_one(AVLMultimapNode* root, int key, AVLMetrics* metrics) {
+    DuplicateChain* chain = multimap_get(root, key, metrics);
+    if (chain == NULL) {
+        return root;
+    }
+
+    DuplicateEntry* entry = chain->head;
+    chain->head = entry->next;
+    tracked_free(entry);
+    if (--chain->count == 0) {
+        root = multimap_delete(root, key, metrics);
+    }
+    return root;
+}
+
+static inline void multimap_free_all(AVLMultimapNode* root) { // chains, then the nodes
+    if (root != NULL) {
+        multimap_free_all(root->left);
+        multimap_free_all(root->right);
+        while (root->value.head != NULL) {
+            DuplicateEntry* next = root->value.head->next;
+            tracked_free(root->value.head);
+            root->value.head = next;
+        }
+        tracked_free(root);
+    }
+}
+
+#endif
@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "orderedset.h"
+#include "memtrack.h"
+#include "bst.h"
+#include "avl.h"
+#include "rbtree.h"
+#include "wavl.h"
+#include "splay.h"
+#include "treap.h"
+#include "scapegoat.h"
+#include "multiset.h"
+
+typedef struct { // handle for the engines whose operations return a new root
+    void* root;
+} RootHandle;
+
+static void* createRootHandle(void) {
+    RootHandle* handle = (RootHandle*)tracked_malloc(sizeof(RootHandle));
+    if (handle == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    handle->root = NULL;
+    return handle;
+}
+
+static void addCounts(TreeMetrics* metrics, long comparisons, long rotations) {
+    METRIC_ADD(metrics, comparisons, comparisons);
+    METRIC_ADD(metrics, rotations, rotations);
+}
+
+// The AVL engines share one scratch AVLMetrics per thread: zeroing its retrace
+// histogram on every call would cost more than a lookup. Only the counters
+// folded into TreeMetrics are reset; the histogram just accumulates.
+static _Thread_local AVLMetrics avlNative;
+
+static AVLMetrics* avlCounters(void) {
+    avlNative.comparisons = 0;
+    avlNative.rotations = 0;
+    avlNative.ll_rotations = 0;
+    avlNative.rr_rotations = 0;
+    avlNative.lr_rotations = 0;
+    avlNative.rl_rotations = 0;
+    avlNative.retrace_ops = 0;
+    avlNative.retrace_steps = 0;
+    return &avlNative;
+}
+
+static void addAVLCounts(TreeMetrics* metrics, AVLMetrics* native) {
+    addCounts(metrics, native->comparisons, native->rotations);
+    METRIC_ADD(metrics, ll_rotations, native->ll_rotations);
+    METRIC_ADD(metrics, rr_rotations, native->rr_rotations);
+    METRIC_ADD(metrics, lr_rotations, native->lr_rotations);
+    METRIC_ADD(metrics, rl_rotations, native->rl_rotations);
+    METRIC_ADD(metrics, retrace_ops, native->retrace_ops);
+    METRIC_ADD(metrics, retrace_steps, native->retrace_steps);
+}
+
+// adapters: run the engine with its own metrics type, fold the counts in.
+// RB, WAVL, splay and treap metrics share AVLMetrics' shape but are distinct types.
+#define ROOT(set, Node) ((Node*)((RootHandle*)(set))->root)
+
+static void bstSetInsert(void* set, int key, TreeMetrics* metrics) {
+    Metrics native = {0, 0.0, 0};
+    ((RootHandle*)set)->root = bst_insert(ROOT(set, BSTNode), key, &native);
+    addCounts(metrics, native.comparisons, 0);
+}
+
+static int bstSetContains(void* set, int key, TreeMetrics* metrics) {
+    Metrics native = {0, 0.0, 0};
+    int found = bst_search(ROOT(set, BSTNode), key, &native) != NULL;
+    addCounts(metrics, native.comparisons, 0);
+    return found;
+}
+
+static void bstSetRemove(void* set, int key, TreeMetrics* metrics) {
+    Metrics native = {0, 0.0, 0};
+    ((RootHandle*)set)->root = bst_delete(ROOT(set, BSTNode), key, &native);
+    addCounts(metrics, native.comparisons, 0);
+}
+
+static int bstSetHeight(void* set) {
+    return bst_height(ROOT(set, BSTNode));
+}
+
+static void bstSetDestroy(void* set) {
+    freeBST(ROOT(set, BSTNode));
+    tracked_free(set);
+}
+
+static void avlSetInsert(void* set, int key, TreeMetrics* metrics) {
+    AVLMetrics* native = avlCounters();
+    ((RootHandle*)set)->root = avl_insert(ROOT(set, AVLNode), key, native);
+    addAVLCounts(metrics, native);
+}
+
+static int avlSetContains(void* set, int key, TreeMetrics* metrics) {
+    AVLMetrics* native = avlCounters();
+    int found = avl_search(ROOT(set, AVLNode), key, native) != NULL;
+    addAVLCounts(metrics, native);
+    return found;
+}
+
+static void avlSetRemove(void* set, int key, TreeMetrics* metrics) {
+    AVLMetrics* native = avlCounters();
+    ((RootHandle*)set)->root = avl_delete(ROOT(set, AVLNode), key, native);
+    addAVLCounts(metrics, native);
+}
+
+static int avlSetHeight(void* set) {
+    return avl_height(ROOT(set, AVLNode));
+}
+
+static void avlSetDestroy(void* set) {
+    freeAVL(ROOT(set, AVLNode));
+    tracked_free(set);
+}
+
+static void rbSetInsert(void* set, int key, TreeMetrics* metrics) {
+    RBMetrics native = {0, 0, 0.0, 0};
+    ((RootHandle*)set)->root = rb_insert(ROOT(set, RBNode), key, &native);
+    addCounts(metrics, native.comparisons, native.rotations);
+}
+
+static int rbSetContains(void* set, int key, TreeMetrics* metrics) {
+    RBMetrics native = {0, 0, 0.0, 0};
+    int found = rb_search(ROOT(set, RBNode), key, &native) != NULL;
+    addCounts(metrics, native.comparisons, native.rotations);
+    return found;
+}
+
+static void rbSetRemove(void* set, int key, TreeMetrics* metrics) {
+    RBMetrics native = {0, 0, 0.0, 0};
+    ((RootHandle*)set)->root = rb_delete(ROOT(set, RBNode), key, &native);
+    addCounts(metrics, native.comparisons, native.rotations);
+}
+
+static int rbSetHeight(void* set) {
+    return rb_height(ROOT(set, RBNode));
+}
+
+static void rbSetDestroy(void* set) {
+    freeRB(ROOT(set, RBNode));
+    tracked_free(set);
+}
+
+static void wavlSetInsert(void* set, int key, TreeMetrics* metrics) {
+    WAVLMetrics native = {0, 0, 0.0, 0};
+    ((RootHandle*)set)->root = wavl_insert(ROOT(set, WAVLNode), key, &native);
+    addCounts(metrics, native.comparisons, native.rotations);
+}
+
+static int wavlSetContains(void* set, int key, TreeMetrics* metrics) {
+    WAVLMetrics native = {0, 0, 0.0, 0};
+    int found = wavl_search(ROOT(set, WAVLNode), key, &native) != NULL;
+    addCounts(metrics, native.comparisons, native.rotations);
+    return found;
+}
+
+static void wavlSetRemove(void* set, int key, TreeMetrics* metrics) {
+    WAVLMetrics native = {0, 0, 0.0, 0};
+    ((RootHandle*)set)->root = wavl_delete(ROOT(set, WAVLNode), key, &native);
+    addCounts(metrics, native.comparisons, native.rotations);
+}
+
+static int wavlSetHeight(void* set) {
+    return wavl_height(ROOT(set, WAVLNode));
+}
+
+static void wavlSetDestroy(void* set) {
+    freeWAVL(ROOT(set, WAVLNode));
+    tracked_free(set);
+}
+
+static void splaySetInsert(void* set, int key, TreeMetrics* metrics) {
+    SplayMetrics native = {0, 0, 0.0, 0};
+    ((RootHandle*)set)->root = splay_insert(ROOT(set, SplayNode), key, &native);
+    addCounts(metrics, native.comparisons, native.rotations);
+}
+
+static int splaySetContains(void* set, int key, TreeMetrics* metrics) { // restructures too
+    SplayMetrics native = {0, 0, 0.0, 0};
+    SplayNode* root = splay_search(ROOT(set, SplayNode), key, &native);
+    ((RootHandle*)set)->root = root;
+    addCounts(metrics, native.comparisons, native.rotations);
+    return root != NULL && root->data == key;
+}
+
+static void splaySetRemove(void* set, int key, TreeMetrics* metrics) {
+    SplayMetrics native = {0, 0, 0.0, 0};
+    ((RootHandle*)set)->root = splay_delete(ROOT(set, SplayNode), key, &native);
+    addCounts(metrics, native.comparisons, native.rotations);
+}
+
+static int splaySetHeight(void* set) {
+    return splay_height(ROOT(set, SplayNode));
+}
+
+static void splaySetDestroy(void* set) {
+    freeSplay(ROOT(set, SplayNode));
+    tracked_free(set);
+}
+
+static void treapSetInsert(void* set, int key, TreeMetrics* metrics) {
+    TreapMetrics native = {0, 0, 0.0, 0};
+    ((RootHandle*)set)->root = treap_insert(ROOT(set, TreapNode), key, &native);
+    addCounts(metrics, native.comparisons, native.rotations);
+}
+
+static int treapSetContains(void* set, int key, TreeMetrics* metrics) {
+    TreapMetrics native = {0, 0, 0.0, 0};
+    int found = treap_search(ROOT(set, TreapNode), key, &native) != NULL;
+    addCounts(metrics, native.comparisons, native.rotations);
+    return found;
+}
+
+static void treapSetRemove(void* set, int key, TreeMetrics* metrics) {
+    TreapMetrics native = {0, 0, 0.0, 0};
+    ((RootHandle*)set)->root = treap_delete(ROOT(set, TreapNode), key, &native);
+    addCounts(metrics, native.comparisons, native.rotations);
+}
+
+static int treapSetHeight(void* set) {
+    return treap_height(ROOT(set, TreapNode));
+}
+
+static void treapSetDestroy(void* set) {
+    freeTreap(ROOT(set, TreapNode));
+    tracked_free(set);
+}
+
+static void* scapegoatSetCreate(void) {
+    return createScapegoatTree(0.7);
+}
+
+static void scapegoatSetInsert(void* set, int key, TreeMetrics* metrics) {
+    SGMetrics native = {0, 0, 0, 0.0, 0};
+    sg_insert((ScapegoatTree*)set, key, &native);
+    addCounts(metrics, native.comparisons, 0);
+    METRIC_ADD(metrics, rebuilds, native.rebuilds);
+    METRIC_ADD(metrics, rebuilt_nodes, native.rebuilt_nodes);
+}
+
+static int scapegoatSetContains(void* set, int key, TreeMetrics* metrics) {
+    SGMetrics native = {0, 0, 0, 0.0, 0};
+    int found = sg_search((ScapegoatTree*)set, key, &native) != NULL;
+    addCounts(metrics, native.comparisons, 0);
+    return found;
+}
+
+static void scapegoatSetRemove(void* set, int key, TreeMetrics* metrics) {
+    SGMetrics native = {0, 0, 0, 0.0, 0};
+    sg_delete((ScapegoatTree*)set, key, &native);
+    addCounts(metrics, native.comparisons, 0);
+    METRIC_ADD(metrics, rebuilds, native.rebuilds);
+    METRIC_ADD(metrics, rebuilt_nodes, native.rebuilt_nodes);
+}
+
+static int scapegoatSetHeight(void* set) {
+    return sg_height((ScapegoatTree*)set);
+}
+
+static void scapegoatSetDestroy(void* set) {
+    freeScapegoat((ScapegoatTree*)set);
+}
+
+static void multisetSetInsert(void* set, int key, TreeMetrics* metrics) { // keeps duplicates as counts
+    AVLMetrics* native = avlCounters();
+    ((RootHandle*)set)->root = multiset_add(ROOT(set, AVLMultisetNode), key, native);
+    addAVLCounts(metrics, native);
+}
+
+static int multisetSetContains(void* set, int key, TreeMetrics* metrics) {
+    AVLMetrics* native = avlCounters();
+    int found = multiset_count(ROOT(set, AVLMultisetNode), key, native) > 0;
+    addAVLCounts(metrics, native);
+    return found;
+}
+
+static void multisetSetRemove(void* set, int key, TreeMetrics* metrics) { // one occurrence
+    AVLMetrics* native = avlCounters();
+    ((RootHandle*)set)->root = multiset_remove_one(ROOT(set, AVLMultisetNode), key, native);
+    addAVLCounts(metrics, native);
+}
+
+static int multisetSetHeight(void* set) {
+    return multiset_height(ROOT(set, AVLMultisetNode));
+}
+
+static void multisetSetDestroy(void* set) {
+    multiset_free(ROOT(set, AVLMultisetNode));
+    tracked_free(set);
+}
+
+static const OrderedSetOps bstSetOps = {"BST", "Binary Search Tree (BST)", 0, createRootHandle,
+    bstSetInsert, bstSetContains, bstSetRemove, bstSetHeight, bstSetDestroy};
+static const OrderedSetOps avlSetOps = {"AVL", "AVL Tree (Balanced)", 1, createRootHandle,
+    avlSetInsert, avlSetContains, avlSetRemove, avlSetHeight, avlSetDestroy};
+static const OrderedSetOps rbSetOps = {"Red-Black", "Red-Black Tree (Balanced)", 1, createRootHandle,
+    rbSetInsert, rbSetContains, rbSetRemove, rbSetHeight, rbSetDestroy};
+static const OrderedSetOps wavlSetOps = {"WAVL", "Weak AVL Tree (rank balanced)", 1, createRootHandle,
+    wavlSetInsert, wavlSetContains, wavlSetRemove, wavlSetHeight, wavlSetDestroy};
+static const OrderedSetOps splaySetOps = {"Splay", "Splay Tree (self-adjusting)", 1, createRootHandle,
+    splaySetInsert, splaySetContains, splaySetRemove, splaySetHeight, splaySetDestroy};
+static const OrderedSetOps treapSetOps = {"Treap", "Treap (randomized)", 1, createRootHandle,
+    treapSetInsert, treapSetContains, treapSetRemove, treapSetHeight, treapSetDestroy};
+static const OrderedSetOps scapegoatSetOps = {"Scapegoat", "Scapegoat Tree (no per-node balance data)", 0,
+    scapegoatSetCreate, scapegoatSetInsert, scapegoatSetContains, scapegoatSetRemove,
+    scapegoatSetHeight, scapegoatSetDestroy};
+static const OrderedSetOps multisetSetOps = {"Multiset", "AVL Multiset (counts duplicates)", 1,
+    createRootHandle, multisetSetInsert, multisetSetContains, multisetSetRemove,
+    multisetSetHeight, multisetSetDestroy};
+
+static const OrderedSetOps* registry[ORDERED_SET_MAX] = {
+    &bstSetOps, &avlSetOps, &rbSetOps, &wavlSetOps, &splaySetOps, &treapSetOps,
+    &scapegoatSetOps, &multisetSetOps,
+};
+static int registered = 8;
+
+int ordered_set_count(void) {
+    return registered;
+}
+
+const OrderedSetOps* ordered_set_get(int index) {
+    if (index < 0 || index >= registered) {
+        return NULL;
+    }
+    return registry[index];
+}
+
+const OrderedSetOps* ordered_set_find(const char* name) {
+    for (int i = 0; i < registered; i++) {
+        if (strcmp(registry[i]->name, name) == 0) {
+            return registry[i];
+        }
+    }
+    return NULL;
+}
+
+int ordered_set_register(const OrderedSetOps* ops) {
+    if (registered == ORDERED_SET_MAX) {
+        return -1;
+    }
+    registry[registered] = ops;
+    return registered++;
+}
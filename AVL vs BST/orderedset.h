@@ -0,0 +1,47 @@
+#ifndef ORDEREDSET_H
+#define ORDEREDSET_H
+
+#include <time.h>
+#include "metrics.h"
+
+// Common ordered-set interface over the tree engines. Each engine provides an
+// OrderedSetOps table whose functions take an opaque set handle and report
+// into one TreeMetrics type; counters an engine doesn't have stay 0. The
+// registry lists the built-in engines, and ordered_set_register adds more,
+// so experiments can run every phase over all of them in one loop.
+
+typedef struct { // unified metrics
+    long comparisons;
+    long rotations;
+    long rebuilds;      // scapegoat subtree rebuilds
+    long rebuilt_nodes;
+    double time_taken;
+    int final_height;
+    long ll_rotations; // AVL rebalancing cases and retracing, see AVLMetrics
+    long rr_rotations;
+    long lr_rotations;
+    long rl_rotations;
+    long retrace_ops;
+    long retrace_steps;
+} TreeMetrics;
+
+typedef struct {
+    const char* name;
+    const char* description; // shown next to the name in reports
+    int rotates;             // 1 if rotations are meaningful for this engine
+    void* (*create)(void);
+    void (*insert)(void* set, int key, TreeMetrics* metrics);
+    int (*contains)(void* set, int key, TreeMetrics* metrics);
+    void (*remove)(void* set, int key, TreeMetrics* metrics);
+    int (*height)(void* set);
+    void (*destroy)(void* set);
+} OrderedSetOps;
+
+#define ORDERED_SET_MAX 32 // registry capacity
+
+int ordered_set_count(void);
+const OrderedSetOps* ordered_set_get(int index);
+const OrderedSetOps* ordered_set_find(const char* name); // NULL if not registered
+int ordered_set_register(const OrderedSetOps* ops); // index, or -1 when full
+
+#endif
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "output.h"
+
+static const char digitPairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+size_t formatInt(char* dest, int value) { // two digits per division, right to left
+    char digits[OUTPUT_INT_MAX_CHARS];
+    char* end = digits + sizeof(digits);
+    char* p = end;
+    unsigned int u = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+
+    while (u >= 100) {
+        unsigned int pair = (u % 100) * 2;
+        u /= 100;
+        *--p = digitPairs[pair + 1];
+        *--p = digitPairs[pair];
+    }
+    if (u >= 10) {
+        *--p = digitPairs[u * 2 + 1];
+        *--p = digitPairs[u * 2];
+    } else {
+        *--p = (char)('0' + u);
+    }
+    if (value < 0) {
+        *--p = '-';
+    }
+
+    size_t length = (size_t)(end - p);
+    memcpy(dest, p, length);
+    return length;
+}
+
+void output_init(OutputBuffer* out, int fd) {
+    out->fd = fd;
+    out->length = 0;
+}
+
+void output_int(OutputBuffer* out, int value) {
+    if (out->length + OUTPUT_INT_MAX_CHARS > OUTPUT_BUFFER_SIZE) {
+        output_flush(out);
+    }
+    out->length += formatInt(out->data + out->length, value);
+    out->data[out->length++] = ' ';
+}
+
+void output_flush(OutputBuffer* out) { // retries short writes
+    size_t written = 0;
+    while (written < out->length) {
+        ssize_t n = write(out->fd, out->data + written, out->length - written);
+        if (n < 0) {
+            perror("write");
+            exit(1);
+        }
+        written += (size_t)n;
+    }
+    out->length = 0;
+}
+
+void dump_init(DumpBuffer* out, char* buffer, size_t capacity) {
+    out->data = buffer;
+    out->capacity = capacity;
+    out->length = 0;
+    out->written = 0;
+}
+
+void dump_int(DumpBuffer* out, int value) {
+    char text[OUTPUT_INT_MAX_CHARS];
+    size_t length = formatInt(text, value);
+    text[length++] = ' ';
+    if (out->written == out->length && out->length + length < out->capacity) { // nothing dropped yet
+        memcpy(out->data + out->written, text, length);
+        out->written += length;
+    }
+    out->length += length;
+}
+
+size_t dump_finish(DumpBuffer* out) {
+    if (out->capacity > 0) {
+        out->data[out->written] = '\0';
+    }
+    return out->length;
+}
@@ -0,0 +1,34 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+#define OUTPUT_INT_MAX_CHARS 12 // "-2147483648 "
+
+typedef struct { // write buffer flushed to a file descriptor with write(2)
+    int fd;
+    size_t length;
+    char data[OUTPUT_BUFFER_SIZE];
+} OutputBuffer;
+
+typedef struct { // caller-supplied buffer, counts past the end so the caller can size it
+    char* data;
+    size_t capacity;
+    size_t length;  // full text length, written or not
+    size_t written; // bytes actually stored
+} DumpBuffer;
+
+size_t formatInt(char* dest, int value); // no terminator, returns length
+void output_init(OutputBuffer* out, int fd);
+void output_int(OutputBuffer* out, int value); // value followed by a space
+void output_flush(OutputBuffer* out);
+
+// like snprintf: whole values are stored while they fit with room for the
+// terminating NUL, dump_finish terminates (if capacity > 0) and returns the
+// full length, so a result >= capacity means the text was cut short
+void dump_init(DumpBuffer* out, char* buffer, size_t capacity);
+void dump_int(DumpBuffer* out, int value); // value followed by a space
+size_t dump_finish(DumpBuffer* out);
+
+#endif
@@ -0,0 +1,79 @@
+#define _GNU_SOURCE // syscall
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "perfcount.h"
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+int perf_counter_open(PerfEvent event) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    switch (event) {
+    case PERF_DTLB_LOAD_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    default:
+        return -1;
+    }
+
+    long fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0); // this thread, any cpu
+    return fd < 0 ? -1 : (int)fd;
+}
+
+void perf_counter_start(int fd) {
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+long long perf_counter_stop(int fd) {
+    long long count;
+    if (fd < 0) {
+        return -1;
+    }
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) {
+        return -1;
+    }
+    return count;
+}
+
+void perf_counter_close(int fd) {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+#else // no perf_event_open
+
+int perf_counter_open(PerfEvent event) {
+    (void)event;
+    return -1;
+}
+
+void perf_counter_start(int fd) {
+    (void)fd;
+}
+
+long long perf_counter_stop(int fd) {
+    (void)fd;
+    return -1;
+}
+
+void perf_counter_close(int fd) {
+    (void)fd;
+}
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef PERFCOUNT_H
+#define PERFCOUNT_H
+
+// Hardware event counters for this thread through perf_event_open (Linux).
+// Opening fails without kernel support or permission (perf_event_paranoid,
+// containers, VMs without a PMU); callers then report "n/a".
+
+typedef enum {
+    PERF_DTLB_LOAD_MISSES
+} PerfEvent;
+
+int perf_counter_open(PerfEvent event); // fd, or -1 when unavailable
+void perf_counter_start(int fd);
+long long perf_counter_stop(int fd); // events since start, -1 on error
+void perf_counter_close(int fd);
+
+#endif
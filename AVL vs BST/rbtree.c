@@ -0,0 +1,312 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "rbtree.h"
+#include "memtrack.h"
+
+static void rb_set_parent(RBNode* node, RBNode* parent) {
+    node->parent_color = (uintptr_t)parent | (node->parent_color & 1);
+}
+
+static void rb_set_color(RBNode* node, int color) {
+    node->parent_color = (node->parent_color & ~(uintptr_t)1) | (uintptr_t)color;
+}
+
+static int rb_is_red(RBNode* node) { // null leaves count as black
+    return node != NULL && rb_color(node) == RB_RED;
+}
+
+RBNode* createRBNode(int data) {
+    RBNode* newNode = (RBNode*)tracked_malloc(sizeof(RBNode)); // new red node
+    if (newNode == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    newNode->data = data;
+    newNode->parent_color = RB_RED;
+    newNode->left = NULL;
+    newNode->right = NULL;
+    return newNode;
+}
+
+// replace the link from old's parent (or the root) with node
+static void rb_replace_child(RBNode** root, RBNode* parent, RBNode* old, RBNode* node) {
+    if (parent == NULL) {
+        *root = node;
+    } else if (parent->left == old) {
+        parent->left = node;
+    } else {
+        parent->right = node;
+    }
+}
+
+static void rb_rotate_left(RBNode** root, RBNode* x, RBMetrics* metrics) {
+    RBNode* y = x->right;
+    RBNode* parent = rb_parent(x);
+
+    x->right = y->left;
+    if (y->left != NULL) {
+        rb_set_parent(y->left, x);
+    }
+    y->left = x;
+
+    rb_set_parent(y, parent);
+    rb_replace_child(root, parent, x, y);
+    rb_set_parent(x, y);
+
+    METRIC_INC(metrics, rotations);
+}
+
+static void rb_rotate_right(RBNode** root, RBNode* y, RBMetrics* metrics) {
+    RBNode* x = y->left;
+    RBNode* parent = rb_parent(y);
+
+    y->left = x->right;
+    if (x->right != NULL) {
+        rb_set_parent(x->right, y);
+    }
+    x->right = y;
+
+    rb_set_parent(x, parent);
+    rb_replace_child(root, parent, y, x);
+    rb_set_parent(y, x);
+
+    METRIC_INC(metrics, rotations);
+}
+
+RBNode* rb_insert(RBNode* root, int data, RBMetrics* metrics) { // insert into red-black tree
+    RBNode* parent = NULL;
+    RBNode** link = &root;
+
+    while (*link != NULL) { // iterative bst descent
+        parent = *link;
+        METRIC_INC(metrics, comparisons);
+
+        if (data < parent->data) {
+            link = &parent->left;
+        } else if (data > parent->data) {
+            link = &parent->right;
+        } else {
+            return root;
+        }
+    }
+
+    RBNode* node = createRBNode(data);
+    rb_set_parent(node, parent);
+    *link = node;
+
+    // fix red-red violations walking up
+    while ((parent = rb_parent(node)) != NULL && rb_is_red(parent)) {
+        RBNode* grandparent = rb_parent(parent); // exists since root is black
+
+        if (parent == grandparent->left) {
+            RBNode* uncle = grandparent->right;
+
+            if (rb_is_red(uncle)) { // recolor and move up
+                rb_set_color(parent, RB_BLACK);
+                rb_set_color(uncle, RB_BLACK);
+                rb_set_color(grandparent, RB_RED);
+                node = grandparent;
+                continue;
+            }
+
+            if (node == parent->right) { // left-right case
+                rb_rotate_left(&root, parent, metrics);
+                node = parent;
+                parent = rb_parent(node);
+            }
+
+            rb_set_color(parent, RB_BLACK); // left-left case
+            rb_set_color(grandparent, RB_RED);
+            rb_rotate_right(&root, grandparent, metrics);
+        } else {
+            RBNode* uncle = grandparent->left;
+
+            if (rb_is_red(uncle)) {
+                rb_set_color(parent, RB_BLACK);
+                rb_set_color(uncle, RB_BLACK);
+                rb_set_color(grandparent, RB_RED);
+                node = grandparent;
+                continue;
+            }
+
+            if (node == parent->left) { // right-left case
+                rb_rotate_right(&root, parent, metrics);
+                node = parent;
+                parent = rb_parent(node);
+            }
+
+            rb_set_color(parent, RB_BLACK); // right-right case
+            rb_set_color(grandparent, RB_RED);
+            rb_rotate_left(&root, grandparent, metrics);
+        }
+    }
+
+    rb_set_color(root, RB_BLACK);
+    return root;
+}
+
+RBNode* rb_search(RBNode* root, int data, RBMetrics* metrics) {
+    while (root != NULL) {
+        METRIC_INC(metrics, comparisons);
+
+        if (data == root->data) {
+            return root;
+        } else if (data < root->data) {
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
+    return NULL;
+}
+
+// restore black height after removing a black node; node may be NULL
+static void rb_delete_fixup(RBNode** root, RBNode* node, RBNode* parent, RBMetrics* metrics) {
+    while (node != *root && !rb_is_red(node)) {
+        if (node == parent->left) {
+            RBNode* sibling = parent->right;
+
+            if (rb_is_red(sibling)) { // red sibling, rotate to get a black one
+                rb_set_color(sibling, RB_BLACK);
+                rb_set_color(parent, RB_RED);
+                rb_rotate_left(root, parent, metrics);
+                sibling = parent->right;
+            }
+
+            if (!rb_is_red(sibling->left) && !rb_is_red(sibling->right)) {
+                rb_set_color(sibling, RB_RED); // push the deficit up
+                node = parent;
+                parent = rb_parent(node);
+                continue;
+            }
+
+            if (!rb_is_red(sibling->right)) {
+                rb_set_color(sibling->left, RB_BLACK);
+                rb_set_color(sibling, RB_RED);
+                rb_rotate_right(root, sibling, metrics);
+                sibling = parent->right;
+            }
+
+            rb_set_color(sibling, rb_color(parent));
+            rb_set_color(parent, RB_BLACK);
+            rb_set_color(sibling->right, RB_BLACK);
+            rb_rotate_left(root, parent, metrics);
+            node = *root;
+        } else {
+            RBNode* sibling = parent->left;
+
+            if (rb_is_red(sibling)) {
+                rb_set_color(sibling, RB_BLACK);
+                rb_set_color(parent, RB_RED);
+                rb_rotate_right(root, parent, metrics);
+                sibling = parent->left;
+            }
+
+            if (!rb_is_red(sibling->left) && !rb_is_red(sibling->right)) {
+                rb_set_color(sibling, RB_RED);
+                node = parent;
+                parent = rb_parent(node);
+                continue;
+            }
+
+            if (!rb_is_red(sibling->left)) {
+                rb_set_color(sibling->right, RB_BLACK);
+                rb_set_color(sibling, RB_RED);
+                rb_rotate_left(root, sibling, metrics);
+                sibling = parent->left;
+            }
+
+            rb_set_color(sibling, rb_color(parent));
+            rb_set_color(parent, RB_BLACK);
+            rb_set_color(sibling->left, RB_BLACK);
+            rb_rotate_right(root, parent, metrics);
+            node = *root;
+        }
+    }
+
+    if (node != NULL) {
+        rb_set_color(node, RB_BLACK);
+    }
+}
+
+RBNode* rb_delete(RBNode* root, int data, RBMetrics* metrics) { // delete
+    RBNode* node = rb_search(root, data, metrics);
+    if (node == NULL) {
+        return root;
+    }
+
+    RBNode* child;
+    RBNode* parent;
+    int removedColor;
+
+    if (node->left == NULL || node->right == NULL) { // at most one child, splice out
+        child = node->left ? node->left : node->right;
+        parent = rb_parent(node);
+        removedColor = rb_color(node);
+
+        if (child != NULL) {
+            rb_set_parent(child, parent);
+        }
+        rb_replace_child(&root, parent, node, child);
+    } else { // two children, relink the successor into node's place
+        RBNode* successor = node->right;
+        while (successor->left != NULL) {
+            successor = successor->left;
+        }
+
+        child = successor->right;
+        removedColor = rb_color(successor);
+
+        if (rb_parent(successor) == node) {
+            parent = successor;
+        } else {
+            parent = rb_parent(successor);
+            parent->left = child;
+            if (child != NULL) {
+                rb_set_parent(child, parent);
+            }
+            successor->right = node->right;
+            rb_set_parent(node->right, successor);
+        }
+
+        successor->left = node->left;
+        rb_set_parent(node->left, successor);
+        rb_replace_child(&root, rb_parent(node), node, successor);
+        successor->parent_color = node->parent_color; // takes over parent and color
+    }
+
+    tracked_free(node);
+
+    if (removedColor == RB_BLACK) {
+        rb_delete_fixup(&root, child, parent, metrics);
+    }
+
+    return root;
+}
+
+int rb_height(RBNode* root) {
+    if (root == NULL) {
+        return 0;
+    }
+
+    int leftHeight = rb_height(root->left);
+    int rightHeight = rb_height(root->right);
+
+    return (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+}
+
+void rb_inorder(RBNode* root) { // inorder traversal
+    if (root != NULL) {
+        rb_inorder(root->left);
+        printf("%d ", root->data);
+        rb_inorder(root->right);
+    }
+}
+
+void freeRB(RBNode* root) { // free memory
+    if (root != NULL) {
+        freeRB(root->left);
+        freeRB(root->right);
+        tracked_free(root);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef RBTREE_H
+#define RBTREE_H
+
+#include <stdint.h>
+#include <time.h>
+#include "metrics.h"
+
+#define RB_RED   0
+#define RB_BLACK 1
+
+typedef struct RBNode { // red-black node, color lives in the low bit of parent
+    int data;
+    uintptr_t parent_color;
+    struct RBNode *left;
+    struct RBNode *right;
+} RBNode;
+
+typedef struct { // metrics (same shape as AVLMetrics)
+    long comparisons;
+    long rotations;
+    double time_taken;
+    int final_height;
+} RBMetrics;
+
+#define rb_parent(n) ((RBNode*)((n)->parent_color & ~(uintptr_t)1))
+#define rb_color(n)  ((int)((n)->parent_color & 1))
+
+RBNode* createRBNode(int data);
+RBNode* rb_insert(RBNode* root, int data, RBMetrics* metrics);
+RBNode* rb_search(RBNode* root, int data, RBMetrics* metrics);
+RBNode* rb_delete(RBNode* root, int data, RBMetrics* metrics);
+int rb_height(RBNode* root);
+void rb_inorder(RBNode* root);
+void freeRB(RBNode* root);
+
+#endif
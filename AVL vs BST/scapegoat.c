@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "scapegoat.h"
+#include "memtrack.h"
+
+// Scapegoat tree (Galperin & Rivest). No balance data is kept in the nodes:
+// an insert that lands deeper than log_{1/alpha}(max_size) walks back up to
+// the first alpha-unbalanced ancestor and rebuilds that subtree perfectly.
+
+ScapegoatTree* createScapegoatTree(double alpha) {
+    if (alpha < 0.5) { // keep the depth bound inside SG_MAX_DEPTH
+        alpha = 0.5;
+    } else if (alpha > 0.8) {
+        alpha = 0.8;
+    }
+
+    ScapegoatTree* tree = (ScapegoatTree*)tracked_malloc(sizeof(ScapegoatTree));
+    if (tree == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    tree->root = NULL;
+    tree->size = 0;
+    tree->max_size = 0;
+    tree->alpha = alpha;
+    tree->log_inv_alpha = log(1.0 / alpha);
+    return tree;
+}
+
+static int sg_size(BSTNode* root) { // subtree size, only walked while looking for a scapegoat
+    if (root == NULL) {
+        return 0;
+    }
+    return sg_size(root->left) + sg_size(root->right) + 1;
+}
+
+// append the subtree's nodes in order as a list linked through right, ending at tail
+static BSTNode* sg_flatten(BSTNode* root, BSTNode* tail) {
+    if (root == NULL) {
+        return tail;
+    }
+    root->right = sg_flatten(root->right, tail);
+    return sg_flatten(root->left, root);
+}
+
+// turn the first n list nodes into a perfectly balanced tree hanging off
+// the left of the returned node, which is the (n+1)-th list node
+static BSTNode* sg_build(int n, BSTNode* head) {
+    if (n == 0) {
+        head->left = NULL;
+        return head;
+    }
+    BSTNode* middle = sg_build((n - 1) - (n - 1) / 2, head);
+    BSTNode* last = sg_build((n - 1) / 2, middle->right);
+    middle->right = last->left;
+    last->left = middle;
+    return last;
+}
+
+static BSTNode* sg_rebuild(BSTNode* root, int n, SGMetrics* metrics) { // linear time, no extra memory
+    BSTNode tail;
+    tail.left = NULL;
+    tail.right = NULL;
+    BSTNode* head = sg_flatten(root, &tail);
+    sg_build(n, head);
+
+    METRIC_INC(metrics, rebuilds);
+    METRIC_ADD(metrics, rebuilt_nodes, n);
+    return tail.left;
+}
+
+void sg_insert(ScapegoatTree* tree, int data, SGMetrics* metrics) { // insert into scapegoat tree
+    BSTNode* path[SG_MAX_DEPTH];
+    int depth = 0;
+    BSTNode** link = &tree->root;
+
+    while (*link != NULL) {
+        BSTNode* node = *link;
+        METRIC_INC(metrics, comparisons);
+
+        if (data < node->data) {
+            link = &node->left;
+        } else if (data > node->data) {
+            link = &node->right;
+        } else {
+            return;
+        }
+        path[depth++] = node;
+    }
+
+    BSTNode* newNode = createBSTNode(data);
+    *link = newNode;
+    tree->size++;
+    if (tree->size > tree->max_size) {
+        tree->max_size = tree->size;
+    }
+
+    if (depth <= (int)floor(log((double)tree->max_size) / tree->log_inv_alpha)) {
+        return;
+    }
+
+    // too deep: the first ancestor whose heavy child exceeds alpha is the scapegoat
+    BSTNode* child = newNode;
+    int childSize = 1;
+    for (int i = depth - 1; i >= 0; i--) {
+        BSTNode* parent = path[i];
+        BSTNode* sibling = (parent->left == child) ? parent->right : parent->left;
+        int parentSize = childSize + 1 + sg_size(sibling);
+
+        if (childSize > tree->alpha * parentSize) {
+            BSTNode* rebuilt = sg_rebuild(parent, parentSize, metrics);
+            if (i == 0) {
+                tree->root = rebuilt;
+            } else if (path[i - 1]->left == parent) {
+                path[i - 1]->left = rebuilt;
+            } else {
+                path[i - 1]->right = rebuilt;
+            }
+            return;
+        }
+
+        child = parent;
+        childSize = parentSize;
+    }
+}
+
+BSTNode* sg_search(ScapegoatTree* tree, int data, SGMetrics* metrics) {
+    BSTNode* node = tree->root;
+    while (node != NULL) {
+        METRIC_INC(metrics, comparisons);
+
+        if (data == node->data) {
+            return node;
+        } else if (data < node->data) {
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return NULL;
+}
+
+void sg_delete(ScapegoatTree* tree, int data, SGMetrics* metrics) { // delete, rebuild all once size drops below alpha * max
+    BSTNode** link = &tree->root;
+
+    while (*link != NULL && (*link)->data != data) {
+        METRIC_INC(metrics, comparisons);
+        link = (data < (*link)->data) ? &(*link)->left : &(*link)->right;
+    }
+    if (*link == NULL) {
+        return;
+    }
+    METRIC_INC(metrics, comparisons);
+
+    BSTNode* node = *link;
+    if (node->left == NULL || node->right == NULL) {
+        *link = node->left ? node->left : node->right;
+        tracked_free(node);
+    } else { // two children, pull up the successor's key
+        BSTNode** successorLink = &node->right;
+        while ((*successorLink)->left != NULL) {
+            successorLink = &(*successorLink)->left;
+        }
+        BSTNode* successor = *successorLink;
+        node->data = successor->data;
+        *successorLink = successor->right;
+        tracked_free(successor);
+    }
+
+    tree->size--;
+    if (tree->size < tree->alpha * tree->max_size) {
+        if (tree->size > 0) {
+            tree->root = sg_rebuild(tree->root, tree->size, metrics);
+        }
+        tree->max_size = tree->size;
+    }
+}
+
+int sg_height(ScapegoatTree* tree) {
+    return bst_height(tree->root);
+}
+
+void freeScapegoat(ScapegoatTree* tree) { // free memory
+    freeBST(tree->root);
+    tracked_free(tree);
+}
@@ -0,0 +1,32 @@
+#ifndef SCAPEGOAT_H
+#define SCAPEGOAT_H
+
+#include <time.h>
+#include "bst.h"
+
+#define SG_MAX_DEPTH 128 // enough for 2^31 keys with alpha up to 0.8
+
+typedef struct { // nodes are plain BSTNodes, balance state is per tree only
+    BSTNode* root;
+    int size;
+    int max_size;
+    double alpha;
+    double log_inv_alpha;
+} ScapegoatTree;
+
+typedef struct { // metrics
+    long comparisons;
+    long rebuilds;
+    long rebuilt_nodes;
+    double time_taken;
+    int final_height;
+} SGMetrics;
+
+ScapegoatTree* createScapegoatTree(double alpha);
+void sg_insert(ScapegoatTree* tree, int data, SGMetrics* metrics);
+BSTNode* sg_search(ScapegoatTree* tree, int data, SGMetrics* metrics);
+void sg_delete(ScapegoatTree* tree, int data, SGMetrics* metrics);
+int sg_height(ScapegoatTree* tree);
+void freeScapegoat(ScapegoatTree* tree);
+
+#endif
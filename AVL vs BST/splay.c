@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "splay.h"
+#include "memtrack.h"
+
+SplayNode* createSplayNode(int data) {
+    SplayNode* newNode = (SplayNode*)tracked_malloc(sizeof(SplayNode));
+    if (newNode == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    newNode->data = data;
+    newNode->left = NULL;
+    newNode->right = NULL;
+    return newNode;
+}
+
+// top-down splay (Sleator & Tarjan): brings data, or the last node on its
+// search path, to the root in a single pass without recursion
+static SplayNode* splay(SplayNode* root, int data, SplayMetrics* metrics) {
+    if (root == NULL) {
+        return NULL;
+    }
+
+    SplayNode header; // header.right holds the left tree, header.left the right tree
+    header.left = NULL;
+    header.right = NULL;
+    SplayNode* leftMax = &header;
+    SplayNode* rightMin = &header;
+
+    for (;;) {
+        METRIC_INC(metrics, comparisons); // one per node on the path
+
+        if (data < root->data) {
+            if (root->left == NULL) {
+                break;
+            }
+            if (data < root->left->data) { // zig-zig: rotate right
+                METRIC_INC(metrics, comparisons); // child visited here, the loop moves past it
+                SplayNode* child = root->left;
+                root->left = child->right;
+                child->right = root;
+                root = child;
+                METRIC_INC(metrics, rotations);
+                if (root->left == NULL) {
+                    break;
+                }
+            }
+            rightMin->left = root; // link right
+            rightMin = root;
+            root = root->left;
+        } else if (data > root->data) {
+            if (root->right == NULL) {
+                break;
+            }
+            if (data > root->right->data) { // zag-zag: rotate left
+                METRIC_INC(metrics, comparisons); // child visited here, the loop moves past it
+                SplayNode* child = root->right;
+                root->right = child->left;
+                child->left = root;
+                root = child;
+                METRIC_INC(metrics, rotations);
+                if (root->right == NULL) {
+                    break;
+                }
+            }
+            leftMax->right = root; // link left
+            leftMax = root;
+            root = root->right;
+        } else {
+            break;
+        }
+    }
+
+    leftMax->right = root->left; // reassemble
+    rightMin->left = root->right;
+    root->left = header.right;
+    root->right = header.left;
+    return root;
+}
+
+SplayNode* splay_insert(SplayNode* root, int data, SplayMetrics* metrics) { // insert at the root
+    if (root == NULL) {
+        return createSplayNode(data);
+    }
+
+    root = splay(root, data, metrics);
+    if (root->data == data) {
+        return root;
+    }
+
+    SplayNode* newNode = createSplayNode(data);
+    if (data < root->data) {
+        newNode->left = root->left;
+        newNode->right = root;
+        root->left = NULL;
+    } else {
+        newNode->right = root->right;
+        newNode->left = root;
+        root->right = NULL;
+    }
+    return newNode;
+}
+
+SplayNode* splay_search(SplayNode* root, int data, SplayMetrics* metrics) {
+    return splay(root, data, metrics);
+}
+
+SplayNode* splay_delete(SplayNode* root, int data, SplayMetrics* metrics) { // delete
+    if (root == NULL) {
+        return NULL;
+    }
+
+    root = splay(root, data, metrics);
+    if (root->data != data) {
+        return root;
+    }
+
+    SplayNode* newRoot;
+    if (root->left == NULL) {
+        newRoot = root->right;
+    } else { // predecessor becomes the root of the left part, with no right child
+        newRoot = splay(root->left, data, metrics);
+        newRoot->right = root->right;
+    }
+    tracked_free(root);
+    return newRoot;
+}
+
+int splay_height(SplayNode* root) { // iterative, splay trees can degenerate into long paths
+    if (root == NULL) {
+        return 0;
+    }
+
+    int capacity = 64;
+    int top = 0;
+    int maxDepth = 0;
+    SplayNode** nodes = (SplayNode**)malloc(capacity * sizeof(SplayNode*));
+    int* depths = (int*)malloc(capacity * sizeof(int));
+    if (nodes == NULL || depths == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+
+    nodes[top] = root;
+    depths[top++] = 1;
+    while (top > 0) {
+        top--;
+        SplayNode* node = nodes[top];
+        int depth = depths[top];
+        if (depth > maxDepth) {
+            maxDepth = depth;
+        }
+
+        if (top + 2 > capacity) {
+            capacity *= 2;
+            nodes = (SplayNode**)realloc(nodes, capacity * sizeof(SplayNode*));
+            depths = (int*)realloc(depths, capacity * sizeof(int));
+            if (nodes == NULL || depths == NULL) {
+                printf("Memory allocation failed!\n");
+                exit(1);
+            }
+        }
+        if (node->left != NULL) {
+            nodes[top] = node->left;
+            depths[top++] = depth + 1;
+        }
+        if (node->right != NULL) {
+            nodes[top] = node->right;
+            depths[top++] = depth + 1;
+        }
+    }
+
+    free(nodes);
+    free(depths);
+    return maxDepth;
+}
+
+void splay_inorder(SplayNode* root) { // inorder traversal
+    if (root != NULL) {
+        splay_inorder(root->left);
+        printf("%d ", root->data);
+        splay_inorder(root->right);
+    }
+}
+
+void freeSplay(SplayNode* root) { // free memory, rotating left children up so no recursion is needed
+    while (root != NULL) {
+        if (root->left != NULL) {
+            SplayNode* child = root->left;
+            root->left = child->right;
+            child->right = root;
+            root = child;
+        } else {
+            SplayNode* next = root->right;
+            tracked_free(root);
+            root = next;
+        }
+    }
+}
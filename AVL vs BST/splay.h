@@ -0,0 +1,30 @@
+#ifndef SPLAY_H
+#define SPLAY_H
+
+#include <time.h>
+#include "metrics.h"
+
+typedef struct SplayNode { // splay node, same layout as BSTNode
+    int data;
+    struct SplayNode *left;
+    struct SplayNode *right;
+} SplayNode;
+
+typedef struct { // metrics
+    long comparisons;
+    long rotations;
+    double time_taken;
+    int final_height;
+} SplayMetrics;
+
+// every operation splays, so it returns the new root. splay_search leaves
+// the key at the root when found: check root != NULL && root->data == key
+SplayNode* createSplayNode(int data);
+SplayNode* splay_insert(SplayNode* root, int data, SplayMetrics* metrics);
+SplayNode* splay_search(SplayNode* root, int data, SplayMetrics* metrics);
+SplayNode* splay_delete(SplayNode* root, int data, SplayMetrics* metrics);
+int splay_height(SplayNode* root);
+void splay_inorder(SplayNode* root);
+void freeSplay(SplayNode* root);
+
+#endif
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "treap.h"
+#include "memtrack.h"
+
+TreapNode* createTreapNode(int data) {
+    TreapNode* newNode = (TreapNode*)tracked_malloc(sizeof(TreapNode)); // random heap priority
+    if (newNode == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    newNode->data = data;
+    newNode->priority = rand();
+    newNode->left = NULL;
+    newNode->right = NULL;
+    return newNode;
+}
+
+static TreapNode* treap_rotate_right(TreapNode* y, TreapMetrics* metrics) {
+    TreapNode* x = y->left;
+    y->left = x->right;
+    x->right = y;
+    METRIC_INC(metrics, rotations);
+    return x;
+}
+
+static TreapNode* treap_rotate_left(TreapNode* x, TreapMetrics* metrics) {
+    TreapNode* y = x->right;
+    x->right = y->left;
+    y->left = x;
+    METRIC_INC(metrics, rotations);
+    return y;
+}
+
+TreapNode* treap_insert(TreapNode* root, int data, TreapMetrics* metrics) { // insert as leaf, rotate up by priority
+    if (root == NULL) {
+        return createTreapNode(data);
+    }
+
+    METRIC_INC(metrics, comparisons);
+
+    if (data < root->data) {
+        root->left = treap_insert(root->left, data, metrics);
+        if (root->left->priority > root->priority) {
+            return treap_rotate_right(root, metrics);
+        }
+    } else if (data > root->data) {
+        root->right = treap_insert(root->right, data, metrics);
+        if (root->right->priority > root->priority) {
+            return treap_rotate_left(root, metrics);
+        }
+    }
+
+    return root;
+}
+
+TreapNode* treap_search(TreapNode* root, int data, TreapMetrics* metrics) {
+    while (root != NULL) {
+        METRIC_INC(metrics, comparisons);
+
+        if (data == root->data) {
+            return root;
+        } else if (data < root->data) {
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
+    return NULL;
+}
+
+TreapNode* treap_delete(TreapNode* root, int data, TreapMetrics* metrics) { // rotate the node down to a leaf
+    if (root == NULL) {
+        return NULL;
+    }
+
+    METRIC_INC(metrics, comparisons);
+
+    if (data < root->data) {
+        root->left = treap_delete(root->left, data, metrics);
+    } else if (data > root->data) {
+        root->right = treap_delete(root->right, data, metrics);
+    } else {
+        if (root->left == NULL) {
+            TreapNode* temp = root->right;
+            tracked_free(root);
+            return temp;
+        } else if (root->right == NULL) {
+            TreapNode* temp = root->left;
+            tracked_free(root);
+            return temp;
+        }
+
+        // lift the higher priority child, keep pushing the node down
+        if (root->left->priority > root->right->priority) {
+            root = treap_rotate_right(root, metrics);
+            root->right = treap_delete(root->right, data, metrics);
+        } else {
+            root = treap_rotate_left(root, metrics);
+            root->left = treap_delete(root->left, data, metrics);
+        }
+    }
+
+    return root;
+}
+
+int treap_height(TreapNode* root) {
+    if (root == NULL) {
+        return 0;
+    }
+
+    int leftHeight = treap_height(root->left);
+    int rightHeight = treap_height(root->right);
+
+    return (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+}
+
+void treap_inorder(TreapNode* root) { // inorder traversal
+    if (root != NULL) {
+        treap_inorder(root->left);
+        printf("%d ", root->data);
+        treap_inorder(root->right);
+    }
+}
+
+void freeTreap(TreapNode* root) { // free memory
+    if (root != NULL) {
+        freeTreap(root->left);
+        freeTreap(root->right);
+        tracked_free(root);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef TREAP_H
+#define TREAP_H
+
+#include <time.h>
+#include "metrics.h"
+
+typedef struct TreapNode { // bst on data, max-heap on random priority
+    int data;
+    int priority;
+    struct TreapNode *left;
+    struct TreapNode *right;
+} TreapNode;
+
+typedef struct { // metrics
+    long comparisons;
+    long rotations;
+    double time_taken;
+    int final_height;
+} TreapMetrics;
+
+TreapNode* createTreapNode(int data);
+TreapNode* treap_insert(TreapNode* root, int data, TreapMetrics* metrics);
+TreapNode* treap_search(TreapNode* root, int data, TreapMetrics* metrics);
+TreapNode* treap_delete(TreapNode* root, int data, TreapMetrics* metrics);
+int treap_height(TreapNode* root);
+void treap_inorder(TreapNode* root);
+void freeTreap(TreapNode* root);
+
+#endif
@@ -0,0 +1,208 @@
+#define _POSIX_C_SOURCE 200112L // fsync, ftruncate
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "wal.h"
+#include "avlfile.h"
+
+static uint32_t walChecksum(const WALRecord* record) { // fnv-1a over lsn, key and op
+    const unsigned char* bytes = (const unsigned char*)record;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(WALRecord, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static int writeAll(int fd, const void* data, size_t length) {
+    const char* p = (const char*)data;
+    while (length > 0) {
+        ssize_t written = write(fd, p, length);
+        if (written < 0) {
+            return 0;
+        }
+        p += written;
+        length -= written;
+    }
+    return 1;
+}
+
+static int syncPath(const char* path) { // fsync a file we wrote through stdio
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    int ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+static int syncParentDirectory(const char* path) { // makes a rename in that directory durable
+    char dir[WAL_PATH_MAX];
+    const char* slash = strrchr(path, '/');
+    if (slash == NULL) {
+        snprintf(dir, sizeof(dir), ".");
+    } else if (slash == path) {
+        snprintf(dir, sizeof(dir), "/");
+    } else {
+        snprintf(dir, sizeof(dir), "%.*s", (int)(slash - path), path);
+    }
+    return syncPath(dir);
+}
+
+static AVLNode* applyRecord(AVLNode* root, const WALRecord* record, AVLMetrics* metrics) {
+    if (record->op == WAL_INSERT) {
+        return avl_insert(root, record->key, metrics);
+    }
+    return avl_delete(root, record->key, metrics);
+}
+
+// Replays records until the end or the first torn/corrupt one, then cuts the
+// log there so new records follow valid ones. The log may still hold records
+// the checkpoint already contains (crash between rename and truncate); replay
+// is still exact because insert and delete on a set only depend on the last
+// operation per key.
+static long replayLog(WAL* wal, AVLNode** root) {
+    AVLMetrics metrics = {0};
+    WALRecord record;
+    long replayed = 0;
+    off_t valid = 0;
+
+    while (read(wal->fd, &record, sizeof(record)) == (ssize_t)sizeof(record)) {
+        if (record.checksum != walChecksum(&record) ||
+            (record.op != WAL_INSERT && record.op != WAL_DELETE) ||
+            (replayed > 0 && record.lsn != wal->next_lsn)) {
+            break;
+        }
+        *root = applyRecord(*root, &record, &metrics);
+        wal->next_lsn = record.lsn + 1;
+        valid += sizeof(record);
+        replayed++;
+    }
+
+    if (ftruncate(wal->fd, valid) != 0 || lseek(wal->fd, valid, SEEK_SET) != valid) {
+        return -1;
+    }
+    return replayed;
+}
+
+long wal_open(WAL* wal, const char* logPath, const char* checkpointPath, int batchSize,
+              long checkpointEvery, AVLNode** root) {
+    memset(wal, 0, sizeof(WAL));
+    snprintf(wal->log_path, sizeof(wal->log_path), "%s", logPath);
+    snprintf(wal->checkpoint_path, sizeof(wal->checkpoint_path), "%s", checkpointPath);
+    wal->batch_size = batchSize > 0 ? batchSize : 1;
+    wal->checkpoint_every = checkpointEvery;
+    wal->buffer = (WALRecord*)malloc(wal->batch_size * sizeof(WALRecord));
+    if (wal->buffer == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+
+    *root = NULL;
+    if (access(checkpointPath, F_OK) == 0 && avl_load(checkpointPath, root) < 0) {
+        free(wal->buffer);
+        return -1;
+    }
+
+    wal->fd = open(logPath, O_RDWR | O_CREAT, 0644);
+    if (wal->fd < 0) {
+        free(wal->buffer);
+        freeAVL(*root);
+        *root = NULL;
+        return -1;
+    }
+
+    long replayed = replayLog(wal, root);
+    if (replayed < 0) {
+        close(wal->fd);
+        free(wal->buffer);
+        freeAVL(*root); // the snapshot and whatever replayed before the failure
+        *root = NULL;
+    }
+    return replayed;
+}
+
+int wal_commit(WAL* wal) {
+    if (wal->pending == 0) {
+        return 1;
+    }
+    int ok = writeAll(wal->fd, wal->buffer, wal->pending * sizeof(WALRecord)) && fsync(wal->fd) == 0;
+    wal->pending = 0;
+    wal->syncs++;
+    return ok;
+}
+
+int wal_append(WAL* wal, int op, int key) {
+    WALRecord* record = &wal->buffer[wal->pending++];
+    memset(record, 0, sizeof(WALRecord));
+    record->lsn = wal->next_lsn++;
+    record->key = key;
+    record->op = op;
+    record->checksum = walChecksum(record);
+    wal->since_checkpoint++;
+
+    if (wal->pending == wal->batch_size) { // group commit
+        return wal_commit(wal);
+    }
+    return 1;
+}
+
+int wal_checkpoint(WAL* wal, AVLNode* root) {
+    char tmpPath[WAL_PATH_MAX + 4];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", wal->checkpoint_path);
+
+    if (!wal_commit(wal) || avl_save(root, tmpPath) < 0 || !syncPath(tmpPath) ||
+        rename(tmpPath, wal->checkpoint_path) != 0) {
+        remove(tmpPath);
+        return 0;
+    }
+
+    // the rename must be on disk before the log shrinks, or a crash could
+    // bring back the old checkpoint next to an empty log
+    if (!syncParentDirectory(wal->checkpoint_path)) {
+        return 0;
+    }
+
+    // the checkpoint now holds everything logged, the log can start over
+    if (ftruncate(wal->fd, 0) != 0 || lseek(wal->fd, 0, SEEK_SET) != 0 || fsync(wal->fd) != 0) {
+        return 0;
+    }
+    wal->since_checkpoint = 0;
+    wal->checkpoints++;
+    return 1;
+}
+
+void wal_close(WAL* wal) {
+    wal_commit(wal);
+    close(wal->fd);
+    free(wal->buffer);
+    wal->buffer = NULL;
+}
+
+static AVLNode* walApply(WAL* wal, AVLNode* root, int op, int key, AVLMetrics* metrics) {
+    if (!wal_append(wal, op, key)) {
+        printf("WAL write failed!\n");
+        exit(1);
+    }
+
+    WALRecord record = {0, key, (uint32_t)op, 0, 0};
+    root = applyRecord(root, &record, metrics);
+
+    if (wal->checkpoint_every > 0 && wal->since_checkpoint >= wal->checkpoint_every &&
+        !wal_checkpoint(wal, root)) {
+        printf("WAL checkpoint failed!\n");
+        exit(1);
+    }
+    return root;
+}
+
+AVLNode* wal_insert(WAL* wal, AVLNode* root, int key, AVLMetrics* metrics) {
+    return walApply(wal, root, WAL_INSERT, key, metrics);
+}
+
+AVLNode* wal_delete(WAL* wal, AVLNode* root, int key, AVLMetrics* metrics) {
+    return walApply(wal, root, WAL_DELETE, key, metrics);
+}
@@ -0,0 +1,54 @@
+#ifndef WAL_H
+#define WAL_H
+
+#include <stdint.h>
+#include "avl.h"
+
+// Write-ahead log for a durable AVL set. Every insert/delete is appended to
+// the log before it touches the tree; records are buffered and written with
+// one fsync per batch_size records (group commit), so a crash loses at most
+// the uncommitted tail of the current batch. A checkpoint writes the whole
+// tree with avl_save to a temporary file, renames it over the checkpoint and
+// empties the log. Recovery loads the checkpoint and replays the log.
+
+#define WAL_INSERT 1
+#define WAL_DELETE 2
+#define WAL_PATH_MAX 1024
+
+typedef struct { // 24 bytes on disk
+    uint64_t lsn; // consecutive from the first record in the log
+    int32_t key;
+    uint32_t op;
+    uint32_t checksum; // fnv-1a over the fields above
+    uint32_t reserved;
+} WALRecord;
+
+typedef struct {
+    int fd;
+    char log_path[WAL_PATH_MAX];
+    char checkpoint_path[WAL_PATH_MAX];
+    uint64_t next_lsn;
+    int batch_size;       // records per fsync
+    int pending;          // buffered, not yet durable
+    long checkpoint_every; // records between automatic checkpoints, 0 for never
+    long since_checkpoint;
+    long syncs;
+    long checkpoints;
+    WALRecord* buffer;
+} WAL;
+
+// opens (creating if needed) the log and checkpoint, rebuilds the tree into
+// *root; returns log records replayed, or -1 (and *root NULL) on i/o error or
+// a bad checkpoint
+long wal_open(WAL* wal, const char* logPath, const char* checkpointPath, int batchSize,
+              long checkpointEvery, AVLNode** root);
+int wal_append(WAL* wal, int op, int key); // 0 on i/o error
+int wal_commit(WAL* wal); // write and fsync the buffered records, 0 on i/o error
+int wal_checkpoint(WAL* wal, AVLNode* root); // 0 on i/o error, the old log is kept then
+void wal_close(WAL* wal); // commits what is buffered
+
+// log, apply, checkpoint when due; i/o errors are fatal
+AVLNode* wal_insert(WAL* wal, AVLNode* root, int key, AVLMetrics* metrics);
+AVLNode* wal_delete(WAL* wal, AVLNode* root, int key, AVLMetrics* metrics);
+
+#endif
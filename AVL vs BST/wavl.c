@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "wavl.h"
+#include "memtrack.h"
+
+// Weak AVL tree (Haeupler, Sen, Tarjan). Every rank difference is 1 or 2 and
+// every leaf has rank 0. Insert-only trees are exactly AVL trees, while a
+// delete does at most two rotations and O(1) amortized demotions.
+
+WAVLNode* createWAVLNode(int data) {
+    WAVLNode* newNode = (WAVLNode*)tracked_malloc(sizeof(WAVLNode)); // new leaf, rank 0
+    if (newNode == NULL) {
+        printf("Memory allocation failed!\n");
+        exit(1);
+    }
+    newNode->data = data;
+    newNode->rank = 0;
+    newNode->left = NULL;
+    newNode->right = NULL;
+    return newNode;
+}
+
+static int wavl_rank(WAVLNode* node) { // missing nodes have rank -1
+    if (node == NULL) {
+        return -1;
+    }
+    return node->rank;
+}
+
+static WAVLNode* wavl_rotate_right(WAVLNode* y, WAVLMetrics* metrics) { // ranks are fixed by the caller
+    WAVLNode* x = y->left;
+    y->left = x->right;
+    x->right = y;
+    METRIC_INC(metrics, rotations);
+    return x;
+}
+
+static WAVLNode* wavl_rotate_left(WAVLNode* x, WAVLMetrics* metrics) {
+    WAVLNode* y = x->right;
+    x->right = y->left;
+    y->left = x;
+    METRIC_INC(metrics, rotations);
+    return y;
+}
+
+WAVLNode* wavl_insert(WAVLNode* root, int data, WAVLMetrics* metrics) { // insert into wavl
+    if (root == NULL) {
+        return createWAVLNode(data);
+    }
+
+    METRIC_INC(metrics, comparisons);
+
+    if (data < root->data) {
+        root->left = wavl_insert(root->left, data, metrics);
+
+        if (root->left->rank == root->rank) { // left became a 0-child
+            if (root->rank - wavl_rank(root->right) == 1) { // 0,1 node: promote and continue up
+                root->rank++;
+                return root;
+            }
+
+            WAVLNode* x = root->left; // 0,2 node: rotate and stop
+            if (x->rank - wavl_rank(x->left) == 1) {
+                root->rank--;
+                return wavl_rotate_right(root, metrics);
+            }
+
+            WAVLNode* y = x->right;
+            root->left = wavl_rotate_left(x, metrics);
+            y->rank++;
+            x->rank--;
+            root->rank--;
+            return wavl_rotate_right(root, metrics);
+        }
+    } else if (data > root->data) {
+        root->right = wavl_insert(root->right, data, metrics);
+
+        if (root->right->rank == root->rank) {
+            if (root->rank - wavl_rank(root->left) == 1) {
+                root->rank++;
+                return root;
+            }
+
+            WAVLNode* x = root->right;
+            if (x->rank - wavl_rank(x->right) == 1) {
+                root->rank--;
+                return wavl_rotate_left(root, metrics);
+            }
+
+            WAVLNode* y = x->left;
+            root->right = wavl_rotate_right(x, metrics);
+            y->rank++;
+            x->rank--;
+            root->rank--;
+            return wavl_rotate_left(root, metrics);
+        }
+    }
+
+    return root;
+}
+
+WAVLNode* wavl_search(WAVLNode* root, int data, WAVLMetrics* metrics) {
+    while (root != NULL) {
+        METRIC_INC(metrics, comparisons);
+
+        if (data == root->data) {
+            return root;
+        } else if (data < root->data) {
+            root = root->left;
+        } else {
+            root = root->right;
+        }
+    }
+    return NULL;
+}
+
+// repair z after a removal below it; rank differences are only ever off by one level
+static WAVLNode* wavl_fix_delete(WAVLNode* z, WAVLMetrics* metrics) {
+    if (z->left == NULL && z->right == NULL && z->rank == 1) { // 2,2 leaf
+        z->rank = 0;
+        return z;
+    }
+
+    if (z->rank - wavl_rank(z->left) == 3) { // left is a 3-child
+        WAVLNode* y = z->right;
+
+        if (z->rank - y->rank == 2) { // 3,2: demote and continue up
+            z->rank--;
+            return z;
+        }
+
+        int innerDiff = y->rank - wavl_rank(y->left);
+        int outerDiff = y->rank - wavl_rank(y->right);
+
+        if (innerDiff == 2 && outerDiff == 2) { // sibling is 2,2: double demote
+            z->rank--;
+            y->rank--;
+            return z;
+        }
+
+        if (outerDiff == 1) { // single rotation, done
+            WAVLNode* top = wavl_rotate_left(z, metrics);
+            y->rank++;
+            z->rank--;
+            if (z->left == NULL && z->right == NULL) {
+                z->rank--;
+            }
+            return top;
+        }
+
+        WAVLNode* v = y->left; // double rotation, done
+        z->right = wavl_rotate_right(y, metrics);
+        WAVLNode* top = wavl_rotate_left(z, metrics);
+        v->rank += 2;
+        y->rank--;
+        z->rank -= 2;
+        return top;
+    }
+
+    if (z->rank - wavl_rank(z->right) == 3) { // mirror: right is a 3-child
+        WAVLNode* y = z->left;
+
+        if (z->rank - y->rank == 2) {
+            z->rank--;
+            return z;
+        }
+
+        int innerDiff = y->rank - wavl_rank(y->right);
+        int outerDiff = y->rank - wavl_rank(y->left);
+
+        if (innerDiff == 2 && outerDiff == 2) {
+            z->rank--;
+            y->rank--;
+            return z;
+        }
+
+        if (outerDiff == 1) {
+            WAVLNode* top = wavl_rotate_right(z, metrics);
+            y->rank++;
+            z->rank--;
+            if (z->left == NULL && z->right == NULL) {
+                z->rank--;
+            }
+            return top;
+        }
+
+        WAVLNode* v = y->right;
+        z->left = wavl_rotate_left(y, metrics);
+        WAVLNode* top = wavl_rotate_right(z, metrics);
+        v->rank += 2;
+        y->rank--;
+        z->rank -= 2;
+        return top;
+    }
+
+    return z;
+}
+
+WAVLNode* wavl_delete(WAVLNode* root, int data, WAVLMetrics* metrics) { // delete
+    if (root == NULL) {
+        return root;
+    }
+
+    METRIC_INC(metrics, comparisons);
+
+    if (data < root->data) {
+        root->left = wavl_delete(root->left, data, metrics);
+    } else if (data > root->data) {
+        root->right = wavl_delete(root->right, data, metrics);
+    } else {
+        if (root->left == NULL || root->right == NULL) { // splice out, parent fixes ranks
+            WAVLNode* child = root->left ? root->left : root->right;
+            tracked_free(root);
+            return child;
+        }
+
+        WAVLNode* temp = root->right; // two children, take the successor's key
+        while (temp->left != NULL) {
+            temp = temp->left;
+        }
+        root->data = temp->data;
+        root->right = wavl_delete(root->right, temp->data, metrics);
+    }
+
+    return wavl_fix_delete(root, metrics);
+}
+
+int wavl_height(WAVLNode* root) {
+    if (root == NULL) {
+        return 0;
+    }
+
+    int leftHeight = wavl_height(root->left);
+    int rightHeight = wavl_height(root->right);
+
+    return (leftHeight > rightHeight ? leftHeight : rightHeight) + 1;
+}
+
+void wavl_inorder(WAVLNode* root) { // inorder traversal
+    if (root != NULL) {
+        wavl_inorder(root->left);
+        printf("%d ", root->data);
+        wavl_inorder(root->right);
+    }
+}
+
+void freeWAVL(WAVLNode* root) { // free memory
+    if (root != NULL) {
+        freeWAVL(root->left);
+        freeWAVL(root->right);
+        tracked_free(root);
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef WAVL_H
+#define WAVL_H
+
+#include <time.h>
+#include "metrics.h"
+
+typedef struct WAVLNode { // weak avl node, rank instead of height
+    int data;
+    int rank;
+    struct WAVLNode *left;
+    struct WAVLNode *right;
+} WAVLNode;
+
+typedef struct { // metrics
+    long comparisons;
+    long rotations;
+    double time_taken;
+    int final_height;
+} WAVLMetrics;
+
+WAVLNode* createWAVLNode(int data);
+WAVLNode* wavl_insert(WAVLNode* root, int data, WAVLMetrics* metrics);
+WAVLNode* wavl_search(WAVLNode* root, int data, WAVLMetrics* metrics);
+WAVLNode* wavl_delete(WAVLNode* root, int data, WAVLMetrics* metrics);
+int wavl_height(WAVLNode* root);
+void wavl_inorder(WAVLNode* root);
+void freeWAVL(WAVLNode* root);
+
+#endif